@@ -0,0 +1,245 @@
+// Microbenchmarks for the hot text paths. Built with -DBLOCKSMITH_BENCH=ON;
+// run `blocksmith_bench` for all of them or pass benchmark names to pick.
+// Use a Release build — the numbers mean nothing without optimization.
+
+#include "blockscanner.h"
+#include "textsearch.h"
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+
+namespace {
+
+volatile qsizetype g_sink = 0;   // results land here so no work is optimized away
+
+// Median wall time of `reps` runs of `fn`
+template <typename Fn>
+double medianMs(int reps, Fn &&fn)
+{
+    QList<qint64> times;
+    times.reserve(reps);
+    for (int i = 0; i < reps; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        g_sink += fn();
+        times.append(timer.nsecsElapsed());
+    }
+    std::sort(times.begin(), times.end());
+    return times[reps / 2] / 1e6;
+}
+
+// Time and speedup over the baseline, the first row of each case, plus
+// throughput when the size of the input is given
+void report(const char *name, double ms, double baselineMs, qsizetype bytes = 0)
+{
+    std::printf("  %-34s %10.3f ms  %7.1fx", name, ms, baselineMs / ms);
+    if (bytes > 0)
+        std::printf("  %6.2f GB/s", bytes / (ms * 1e6));
+    std::printf("\n");
+}
+
+// --- Block markers ---
+
+// `blocks` blocks with prose between them; every `unclosedEvery`-th block
+// lacks its closing marker (0: all closed)
+QString makeDocument(int blocks, int unclosedEvery)
+{
+    QString text;
+    for (int i = 0; i < blocks; ++i) {
+        const QString id = QString::number(0x100000 + i, 16);
+        text += QStringLiteral("## Section %1\n\nSome prose about the section, long enough "
+                               "to look like a real paragraph of notes.\n\n").arg(i);
+        text += QStringLiteral("<!-- block: Block %1 [id:%2] -->\n").arg(i).arg(id);
+        for (int line = 0; line < 12; ++line)
+            text += QStringLiteral("- item %1 with a little text after it\n").arg(line);
+        if (unclosedEvery == 0 || i % unclosedEvery != 0)
+            text += QStringLiteral("<!-- /block:%1 -->\n").arg(id);
+        text += u'\n';
+    }
+    return text;
+}
+
+// The pattern SyncEngine indexed files with before BlockScanner
+qsizetype scanWithRegex(const QString &text)
+{
+    static const QRegularExpression blockRx(
+        QStringLiteral("<!-- block:\\s*.+?\\s*\\[id:([a-f0-9]+)\\]\\s*-->\\r?\\n"
+                       "([\\s\\S]*?)\\r?\\n"
+                       "<!-- \\/block:\\1 -->"));
+    qsizetype found = 0;
+    auto it = blockRx.globalMatch(text);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        found += match.capturedLength(2) > 0 ? 1 : 0;
+    }
+    return found;
+}
+
+qsizetype scanWithScanner(const QString &text)
+{
+    qsizetype found = 0;
+    for (const BlockScanner::Span &span : BlockScanner::scan(text))
+        found += span.contentEnd > span.contentStart ? 1 : 0;
+    return found;
+}
+
+void benchBlockScanner()
+{
+    struct Case { const char *name; int blocks; int unclosedEvery; };
+    const Case cases[] = {
+        { "1000 blocks, all closed", 1000, 0 },
+        { "1000 blocks, 1 in 10 unclosed", 1000, 10 },
+    };
+    for (const Case &c : cases) {
+        const QString text = makeDocument(c.blocks, c.unclosedEvery);
+        if (scanWithRegex(text) != scanWithScanner(text))
+            std::printf("  warning: regex and scanner disagree on the block count\n");
+
+        std::printf("%s (%lld KB)\n", c.name,
+                    static_cast<long long>(text.size() * qsizetype(sizeof(QChar)) / 1024));
+        const double regexMs = medianMs(5, [&] { return scanWithRegex(text); });
+        const double scannerMs = medianMs(25, [&] { return scanWithScanner(text); });
+        report("QRegularExpression::globalMatch", regexMs, regexMs);
+        report("BlockScanner::scan", scannerMs, regexMs);
+    }
+}
+
+// --- Case-insensitive search ---
+
+// About `length` UTF-16 units of mixed-case prose; with `unicode`, some
+// words carry accented letters so the text is not pure ASCII
+QString makeProse(qsizetype length, bool unicode)
+{
+    static const char16_t *const words[] = {
+        u"the", u"The", u"block", u"Registry", u"search", u"INDEX", u"file", u"of",
+        u"and", u"Markdown", u"prompt", u"a", u"project", u"sync", u"to", u"with",
+    };
+    static const char16_t *const accented[] = { u"café", u"naïve", u"Déjà", u"Über" };
+
+    QRandomGenerator random(42);
+    QString text;
+    text.reserve(length);
+    int wordsOnLine = 0;
+    while (text.size() < length) {
+        if (unicode && random.bounded(8) == 0)
+            text += QStringView(accented[random.bounded(4)]);
+        else
+            text += QStringView(words[random.bounded(16)]);
+        const bool wrap = ++wordsOnLine == 10;
+        text += wrap ? u'\n' : u' ';
+        if (wrap)
+            wordsOnLine = 0;
+    }
+    // A rare needle, once in the middle and once at the end
+    text.insert(text.size() / 2, QStringLiteral(" Zephyrine "));
+    text += QStringLiteral("ZEPHYRINE\n");
+    return text;
+}
+
+template <typename Find>
+qsizetype countMatches(qsizetype needleSize, Find &&find)
+{
+    qsizetype count = 0;
+    for (qsizetype at = find(0); at >= 0; at = find(at + needleSize))
+        ++count;
+    return count;
+}
+
+void benchTextSearch()
+{
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    std::printf("TextSearch vector pass: SSE2\n");
+#else
+    std::printf("TextSearch vector pass: none (scalar)\n");
+#endif
+
+    struct Case { const char *name; const char16_t *needle; bool unicode; };
+    const Case cases[] = {
+        { "rare ASCII needle, ASCII text", u"zephyrine", false },
+        { "common ASCII needle, ASCII text", u"the", false },
+        { "rare ASCII needle, accented text", u"zephyrine", true },
+        { "non-ASCII needle, accented text", u"CAFÉ", true },
+    };
+    const qsizetype length = 4 * 1024 * 1024;
+    const QString ascii = makeProse(length, false);
+    const QString accented = makeProse(length, true);
+    const QByteArray asciiUtf8 = ascii.toUtf8();
+    const QByteArray accentedUtf8 = accented.toUtf8();
+
+    for (const Case &c : cases) {
+        const QString &text = c.unicode ? accented : ascii;
+        const QByteArray &utf8 = c.unicode ? accentedUtf8 : asciiUtf8;
+        const QString needle = QString::fromUtf16(c.needle);
+        const QByteArray needleUtf8 = needle.toUtf8();
+        const TextSearch::Matcher matcher(needle);
+
+        auto qstring = [&] {
+            return countMatches(needle.size(), [&](qsizetype from) {
+                return text.indexOf(needle, from, Qt::CaseInsensitive);
+            });
+        };
+        auto matcherUtf16 = [&] {
+            return countMatches(needle.size(), [&](qsizetype from) {
+                return matcher.indexIn(QStringView(text), from);
+            });
+        };
+        auto matcherUtf8 = [&] {
+            return countMatches(needleUtf8.size(), [&](qsizetype from) {
+                return matcher.indexIn(QByteArrayView(utf8), from);
+            });
+        };
+        // Case-sensitive byte search: how fast a plain scan of the text can go
+        auto exact = [&] {
+            return countMatches(needleUtf8.size(), [&](qsizetype from) {
+                return QByteArrayView(utf8).indexOf(QByteArrayView(needleUtf8), from);
+            });
+        };
+
+        const qsizetype expected = qstring();
+        if (matcherUtf16() != expected || matcherUtf8() != expected)
+            std::printf("  warning: TextSearch and QString::indexOf disagree on the match count\n");
+
+        std::printf("%s (%lld matches)\n", c.name, static_cast<long long>(expected));
+        const qsizetype utf16Bytes = text.size() * qsizetype(sizeof(QChar));
+        const double baselineMs = medianMs(5, qstring);
+        report("QString::indexOf, CaseInsensitive", baselineMs, baselineMs, utf16Bytes);
+        report("Matcher::indexIn, UTF-16", medianMs(9, matcherUtf16), baselineMs, utf16Bytes);
+        report("Matcher::indexIn, UTF-8", medianMs(9, matcherUtf8), baselineMs, utf8.size());
+        report("QByteArrayView::indexOf (exact)", medianMs(9, exact), baselineMs, utf8.size());
+    }
+}
+
+struct Benchmark {
+    const char *name;
+    std::function<void()> run;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const Benchmark benchmarks[] = {
+        { "blockscanner", benchBlockScanner },
+        { "textsearch", benchTextSearch },
+    };
+
+    QStringList selected;
+    for (int i = 1; i < argc; ++i)
+        selected.append(QString::fromLocal8Bit(argv[i]));
+
+    for (const Benchmark &benchmark : benchmarks) {
+        if (!selected.isEmpty() && !selected.contains(QLatin1String(benchmark.name)))
+            continue;
+        std::printf("== %s ==\n", benchmark.name);
+        benchmark.run();
+        std::printf("\n");
+    }
+    return 0;
+}
@@ -135,6 +135,27 @@ ApplicationWindow {
         }
     }
 
+    Connections {
+        target: AppController.syncEngine
+        function onBlocksPushed(blockIds, fileCount) {
+            toast.show("Pushed " + blockIds.length + " block" + (blockIds.length !== 1 ? "s" : "")
+                       + " to " + fileCount + " file" + (fileCount !== 1 ? "s" : ""))
+        }
+        function onBlocksMerged(blockIds, fileCount, conflicts) {
+            let msg = "Merged " + blockIds.length + " block" + (blockIds.length !== 1 ? "s" : "")
+                      + " into " + fileCount + " file" + (fileCount !== 1 ? "s" : "")
+            if (conflicts.length > 0) {
+                let blocks = new Set(conflicts.map(c => c.blockId)).size
+                msg += " · " + blocks + " block" + (blocks !== 1 ? "s" : "")
+                       + " with conflicts left unchanged"
+            }
+            toast.show(msg)
+        }
+        function onPushFailed(error) {
+            toast.show(error)
+        }
+    }
+
     Connections {
         target: AppController.configManager
         function onSaveFailed(message) {
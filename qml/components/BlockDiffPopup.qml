@@ -19,33 +19,61 @@ Dialog {
     property string filePath: ""
     property string registryContent: ""
     property string fileContent: ""
-    property var diffLines: []
     property bool loadingDiff: false
+    property bool hasDifferences: false
     property string diffRequestId: ""
 
-    // Build per-side models from flat diff list
-    property var leftLines: []   // registry: context + removed, blank for added
-    property var rightLines: []  // file: context + added, blank for removed
+    // Per-side rows, appended as diff chunks arrive
+    ListModel { id: leftModel }    // registry: context + removed, blank for added
+    ListModel { id: rightModel }   // file: context + added, blank for removed
 
     signal pulled()
 
-    function buildSideModels(lines) {
+    function escapeHtml(text) {
+        return text.replace(/&/g, "&amp;").replace(/</g, "&lt;").replace(/>/g, "&gt;")
+    }
+
+    // Rich text for a line with its changed spans highlighted; "" if none
+    function spanHtml(text, spans, color) {
+        if (!spans || spans.length === 0)
+            return ""
+        var html = "", pos = 0
+        for (var i = 0; i < spans.length; i++) {
+            var s = spans[i]
+            html += escapeHtml(text.substring(pos, s.start))
+                  + "<span style=\"background-color:" + color + "\">"
+                  + escapeHtml(text.substr(s.start, s.length)) + "</span>"
+            pos = s.start + s.length
+        }
+        html += escapeHtml(text.substring(pos))
+        return "<span style=\"white-space:pre\">" + html + "</span>"
+    }
+
+    function appendSideRows(lines) {
         var left = [], right = []
         for (var i = 0; i < lines.length; i++) {
             var d = lines[i]
             if (d.type === "context") {
-                left.push({ text: d.text, type: "context", lineNum: d.lineA })
-                right.push({ text: d.text, type: "context", lineNum: d.lineB })
+                left.push({ text: d.text, html: "", type: "context", lineNum: d.lineA })
+                right.push({ text: d.text, html: "", type: "context", lineNum: d.lineB })
             } else if (d.type === "removed") {
-                left.push({ text: d.text, type: "removed", lineNum: d.lineA })
-                right.push({ text: "", type: "blank", lineNum: -1 })
+                left.push({ text: d.text, type: "removed", lineNum: d.lineA,
+                            html: spanHtml(d.text, d.spans, Theme.diffRemovedWordBg) })
+                right.push({ text: "", html: "", type: "blank", lineNum: -1 })
+                hasDifferences = true
             } else if (d.type === "added") {
-                left.push({ text: "", type: "blank", lineNum: -1 })
-                right.push({ text: d.text, type: "added", lineNum: d.lineB })
+                left.push({ text: "", html: "", type: "blank", lineNum: -1 })
+                right.push({ text: d.text, type: "added", lineNum: d.lineB,
+                             html: spanHtml(d.text, d.spans, Theme.diffAddedWordBg) })
+                hasDifferences = true
+            } else if (d.type === "skip") {
+                var skipped = "⋯ " + d.count + " unchanged line" + (d.count === 1 ? "" : "s")
+                left.push({ text: skipped, html: "", type: "skip", lineNum: -1 })
+                right.push({ text: skipped, html: "", type: "skip", lineNum: -1 })
             }
         }
-        leftLines = left
-        rightLines = right
+        leftModel.append(left)
+        rightModel.append(right)
     }
 
     function openDiff(blockId, filePath, registryContent, fileContent) {
@@ -53,9 +81,9 @@ Dialog {
         diffDialog.filePath = filePath
         diffDialog.registryContent = registryContent
         diffDialog.fileContent = fileContent
-        diffDialog.diffLines = []
-        diffDialog.leftLines = []
-        diffDialog.rightLines = []
+        leftModel.clear()
+        rightModel.clear()
+        diffDialog.hasDifferences = false
         diffDialog.loadingDiff = true
         diffDialog.diffRequestId = Date.now().toString() + "-" + Math.random().toString(36).slice(2, 8)
 
@@ -66,11 +94,14 @@ Dialog {
 
     Connections {
         target: AppController.syncEngine
-        function onLineDiffReady(requestId, diff) {
+        function onLineDiffChunk(requestId, lines) {
+            if (requestId !== diffDialog.diffRequestId)
+                return
+            diffDialog.appendSideRows(lines)
+        }
+        function onLineDiffFinished(requestId) {
             if (requestId !== diffDialog.diffRequestId)
                 return
-            diffDialog.diffLines = diff
-            diffDialog.buildSideModels(diff)
             diffDialog.loadingDiff = false
         }
     }
@@ -131,7 +162,7 @@ Dialog {
                     id: leftList
                     anchors.fill: parent
                     anchors.margins: 1
-                    model: diffDialog.leftLines
+                    model: leftModel
                     boundsBehavior: Flickable.StopAtBounds
                     clip: true
 
@@ -141,12 +172,12 @@ Dialog {
                     }
 
                     delegate: Rectangle {
-                        required property var modelData
-                        required property int index
+                        id: lineRow
+                        required property var model
                         width: leftList.width
                         height: diffDialog.lineHeight
-                        color: modelData.type === "removed" ? Theme.diffRemovedBg
-                             : modelData.type === "blank"   ? "transparent"
+                        color: lineRow.model.type === "removed" ? Theme.diffRemovedBg
+                             : lineRow.model.type === "blank"   ? "transparent"
                              : "transparent"
 
                         // Line number gutter
@@ -154,13 +185,13 @@ Dialog {
                             width: diffDialog.gutterWidth
                             height: parent.height
                             color: Qt.darker(parent.color, 1.15)
-                            visible: modelData.type !== "blank"
+                            visible: lineRow.model.type !== "blank" && lineRow.model.type !== "skip"
 
                             Text {
                                 anchors.right: parent.right
                                 anchors.rightMargin: 4
                                 anchors.verticalCenter: parent.verticalCenter
-                                text: modelData.lineNum > 0 ? modelData.lineNum : ""
+                                text: lineRow.model.lineNum > 0 ? lineRow.model.lineNum : ""
                                 font.family: Theme.fontMono
                                 font.pixelSize: Theme.fontSizeS
                                 color: Theme.textMuted
@@ -171,10 +202,10 @@ Dialog {
                         Text {
                             x: diffDialog.gutterWidth + 2
                             anchors.verticalCenter: parent.verticalCenter
-                            text: modelData.type === "removed" ? "−" : " "
+                            text: lineRow.model.type === "removed" ? "−" : " "
                             font.family: Theme.fontMono
                             font.pixelSize: Theme.fontSizeM
-                            color: modelData.type === "removed" ? Theme.accentRed : Theme.textMuted
+                            color: lineRow.model.type === "removed" ? Theme.accentRed : Theme.textMuted
                         }
 
                         // Line text
@@ -182,10 +213,12 @@ Dialog {
                             x: diffDialog.gutterWidth + 16
                             width: parent.width - x - 4
                             anchors.verticalCenter: parent.verticalCenter
-                            text: modelData.text
+                            text: lineRow.model.html !== "" ? lineRow.model.html : lineRow.model.text
+                            textFormat: lineRow.model.html !== "" ? Text.RichText : Text.PlainText
                             font.family: Theme.fontMono
                             font.pixelSize: Theme.fontSizeM
-                            color: Theme.textEditor
+                            font.italic: lineRow.model.type === "skip"
+                            color: lineRow.model.type === "skip" ? Theme.textMuted : Theme.textEditor
                             elide: Text.ElideRight
                         }
 
@@ -220,7 +253,7 @@ Dialog {
                     id: rightList
                     anchors.fill: parent
                     anchors.margins: 1
-                    model: diffDialog.rightLines
+                    model: rightModel
                     boundsBehavior: Flickable.StopAtBounds
                     clip: true
 
@@ -230,12 +263,12 @@ Dialog {
                     }
 
                     delegate: Rectangle {
-                        required property var modelData
-                        required property int index
+                        id: lineRow
+                        required property var model
                         width: rightList.width
                         height: diffDialog.lineHeight
-                        color: modelData.type === "added" ? Theme.diffAddedBg
-                             : modelData.type === "blank" ? "transparent"
+                        color: lineRow.model.type === "added" ? Theme.diffAddedBg
+                             : lineRow.model.type === "blank" ? "transparent"
                              : "transparent"
 
                         // Line number gutter
@@ -243,13 +276,13 @@ Dialog {
                             width: diffDialog.gutterWidth
                             height: parent.height
                             color: Qt.darker(parent.color, 1.15)
-                            visible: modelData.type !== "blank"
+                            visible: lineRow.model.type !== "blank" && lineRow.model.type !== "skip"
 
                             Text {
                                 anchors.right: parent.right
                                 anchors.rightMargin: 4
                                 anchors.verticalCenter: parent.verticalCenter
-                                text: modelData.lineNum > 0 ? modelData.lineNum : ""
+                                text: lineRow.model.lineNum > 0 ? lineRow.model.lineNum : ""
                                 font.family: Theme.fontMono
                                 font.pixelSize: Theme.fontSizeS
                                 color: Theme.textMuted
@@ -260,10 +293,10 @@ Dialog {
                         Text {
                             x: diffDialog.gutterWidth + 2
                             anchors.verticalCenter: parent.verticalCenter
-                            text: modelData.type === "added" ? "+" : " "
+                            text: lineRow.model.type === "added" ? "+" : " "
                             font.family: Theme.fontMono
                             font.pixelSize: Theme.fontSizeM
-                            color: modelData.type === "added" ? Theme.accentGreen : Theme.textMuted
+                            color: lineRow.model.type === "added" ? Theme.accentGreen : Theme.textMuted
                         }
 
                         // Line text
@@ -271,10 +304,12 @@ Dialog {
                             x: diffDialog.gutterWidth + 16
                             width: parent.width - x - 4
                             anchors.verticalCenter: parent.verticalCenter
-                            text: modelData.text
+                            text: lineRow.model.html !== "" ? lineRow.model.html : lineRow.model.text
+                            textFormat: lineRow.model.html !== "" ? Text.RichText : Text.PlainText
                             font.family: Theme.fontMono
                             font.pixelSize: Theme.fontSizeM
-                            color: Theme.textEditor
+                            font.italic: lineRow.model.type === "skip"
+                            color: lineRow.model.type === "skip" ? Theme.textMuted : Theme.textEditor
                             elide: Text.ElideRight
                         }
 
@@ -292,6 +327,14 @@ Dialog {
                 }
             }
 
+            Label {
+                anchors.centerIn: parent
+                visible: !diffDialog.loadingDiff && !diffDialog.hasDifferences
+                text: "No differences"
+                color: Theme.textMuted
+                font.pixelSize: Theme.fontSizeM
+            }
+
             Rectangle {
                 anchors.fill: parent
                 visible: diffDialog.loadingDiff
@@ -10,6 +10,9 @@ Rectangle {
     signal blockEditRequested(string blockId)
     signal blockInsertRequested(string blockId)
 
+    // Refreshed whenever the block index changes
+    property var divergedIds: []
+
     ColumnLayout {
         anchors.fill: parent
         spacing: 0
@@ -41,6 +44,64 @@ Rectangle {
                     color: Theme.textMuted
                 }
 
+                // Push all diverged blocks in one batch
+                Rectangle {
+                    visible: blockPanel.divergedIds.length > 0
+                    width: 22
+                    height: 22
+                    radius: Theme.radius
+                    color: pushAllMa.containsMouse ? Theme.borderHover : "transparent"
+
+                    Label {
+                        anchors.centerIn: parent
+                        text: "\u2191"
+                        font.pixelSize: 14
+                        font.bold: true
+                        color: Theme.accentOrange
+                    }
+
+                    MouseArea {
+                        id: pushAllMa
+                        anchors.fill: parent
+                        hoverEnabled: true
+                        cursorShape: Qt.PointingHandCursor
+                        onClicked: AppController.syncEngine.pushBlocks(blockPanel.divergedIds)
+                    }
+
+                    ToolTip.visible: pushAllMa.containsMouse
+                    ToolTip.text: "Push " + blockPanel.divergedIds.length + " diverged block"
+                                  + (blockPanel.divergedIds.length !== 1 ? "s" : "") + " to their files"
+                }
+
+                // Three-way merge all diverged blocks
+                Rectangle {
+                    visible: blockPanel.divergedIds.length > 0
+                    width: 22
+                    height: 22
+                    radius: Theme.radius
+                    color: mergeAllMa.containsMouse ? Theme.borderHover : "transparent"
+
+                    Label {
+                        anchors.centerIn: parent
+                        text: "\u21c4"
+                        font.pixelSize: 14
+                        font.bold: true
+                        color: Theme.accent
+                    }
+
+                    MouseArea {
+                        id: mergeAllMa
+                        anchors.fill: parent
+                        hoverEnabled: true
+                        cursorShape: Qt.PointingHandCursor
+                        onClicked: AppController.syncEngine.mergeBlocks(blockPanel.divergedIds)
+                    }
+
+                    ToolTip.visible: mergeAllMa.containsMouse
+                    ToolTip.text: "Merge file and registry edits of " + blockPanel.divergedIds.length
+                                  + " diverged block" + (blockPanel.divergedIds.length !== 1 ? "s" : "")
+                }
+
                 // Add block button
                 Rectangle {
                     width: 22
@@ -154,7 +215,10 @@ Rectangle {
 
             Connections {
                 target: AppController.syncEngine
-                function onIndexReady() { blockListView.indexRevision++ }
+                function onIndexReady() {
+                    blockListView.indexRevision++
+                    blockPanel.divergedIds = AppController.syncEngine.divergedBlockIds()
+                }
             }
 
             delegate: BlockCard {
@@ -13,6 +13,12 @@ Rectangle {
     required property bool hasToolUse
     required property string fullJson
     required property bool isExpanded
+    required property bool jsonTruncated
+    required property bool hasParent
+    required property int childCount
+
+    // Ask the list to scroll to another row (parent / thread navigation)
+    signal navigate(int row)
 
     implicitHeight: cardCol.implicitHeight
     color: Theme.bgCard
@@ -119,6 +125,67 @@ Rectangle {
                 }
             }
 
+            // Branch marker — more than one reply continues from here
+            Label {
+                visible: card.childCount > 1
+                text: "\u2442 " + card.childCount
+                font.pixelSize: Theme.fontSizeS
+                color: Theme.accentPurple
+                ToolTip.text: card.childCount + " branches"
+                ToolTip.visible: branchMa.containsMouse
+                ToolTip.delay: 400
+                MouseArea {
+                    id: branchMa
+                    anchors.fill: parent
+                    hoverEnabled: true
+                }
+            }
+
+            // Parent / thread navigation (fade on hover like the copy button)
+            Row {
+                spacing: Theme.sp4
+                opacity: cardMa.containsMouse ? 1 : 0
+                Behavior on opacity { NumberAnimation { duration: 120 } }
+
+                Repeater {
+                    model: [
+                        { glyph: "\u2191", tip: "Go to parent", enabled: card.hasParent },
+                        { glyph: "\u21F5", tip: "Follow this thread", enabled: card.hasParent || card.childCount > 0 }
+                    ]
+                    delegate: Rectangle {
+                        required property var modelData
+                        required property int index
+                        visible: modelData.enabled
+                        width: 22; height: 22; radius: Theme.radius
+                        color: navMa.containsMouse ? Theme.bgButtonHov : Theme.bgButton
+                        ToolTip.text: modelData.tip
+                        ToolTip.visible: navMa.containsMouse
+                        ToolTip.delay: 400
+
+                        Label {
+                            anchors.centerIn: parent
+                            text: parent.modelData.glyph
+                            font.pixelSize: 12
+                            color: Theme.textSecondary
+                        }
+                        MouseArea {
+                            id: navMa
+                            anchors.fill: parent
+                            hoverEnabled: true
+                            cursorShape: Qt.PointingHandCursor
+                            onClicked: function(mouse) {
+                                mouse.accepted = true
+                                let row = parent.index === 0
+                                        ? AppController.jsonlStore.parentRow(card.index)
+                                        : AppController.jsonlStore.followThread(card.index)
+                                if (row >= 0)
+                                    card.navigate(row)
+                            }
+                        }
+                    }
+                }
+            }
+
             // Copy button (fade on hover — no layout shift)
             Rectangle {
                 opacity: cardMa.containsMouse ? 1 : 0
@@ -162,23 +229,48 @@ Rectangle {
             Layout.leftMargin: Theme.sp8
             Layout.rightMargin: Theme.sp8
             Layout.bottomMargin: Theme.sp8
-            Layout.preferredHeight: jsonText.implicitHeight + Theme.sp16
+            Layout.preferredHeight: jsonCol.implicitHeight + Theme.sp16
             color: Theme.bgPanel
             radius: Theme.radius
             border.color: Theme.border
             border.width: 1
 
-            TextEdit {
-                id: jsonText
+            ColumnLayout {
+                id: jsonCol
                 anchors.fill: parent
                 anchors.margins: Theme.sp8
-                text: card.fullJson
-                readOnly: true
-                selectByMouse: true
-                font.family: Theme.fontMono
-                font.pixelSize: Theme.fontSizeM
-                color: Theme.textEditor
-                wrapMode: TextEdit.Wrap
+                spacing: Theme.sp4
+
+                TextEdit {
+                    id: jsonText
+                    Layout.fillWidth: true
+                    text: card.fullJson
+                    readOnly: true
+                    selectByMouse: true
+                    font.family: Theme.fontMono
+                    font.pixelSize: Theme.fontSizeM
+                    color: Theme.textEditor
+                    wrapMode: TextEdit.Wrap
+                }
+
+                // Large entries render in pages; each click shows more
+                Label {
+                    visible: card.jsonTruncated
+                    text: "Show more\u2026"
+                    font.pixelSize: Theme.fontSizeS
+                    color: moreMa.containsMouse ? Theme.textPrimary : Theme.accent
+
+                    MouseArea {
+                        id: moreMa
+                        anchors.fill: parent
+                        hoverEnabled: true
+                        cursorShape: Qt.PointingHandCursor
+                        onClicked: function(mouse) {
+                            mouse.accepted = true
+                            AppController.jsonlStore.showMoreJson(card.index)
+                        }
+                    }
+                }
             }
         }
     }
@@ -11,6 +11,8 @@ Rectangle {
     color: Theme.bgHeader
 
     property alias searchField: searchField
+    // Field edits the structured query instead of the text filter
+    property bool queryMode: false
 
     RowLayout {
         anchors.fill: parent
@@ -24,8 +26,13 @@ Rectangle {
             Layout.preferredHeight: 26
             color: Theme.bg
             radius: Theme.radius
-            border.color: searchField.activeFocus ? Theme.borderFocus : Theme.border
+            border.color: filterBar.queryMode && AppController.jsonlStore.queryError !== ""
+                          ? Theme.accentRed
+                          : searchField.activeFocus ? Theme.borderFocus : Theme.border
             border.width: 1
+            ToolTip.text: AppController.jsonlStore.queryError
+            ToolTip.visible: filterBar.queryMode && searchField.activeFocus
+                             && AppController.jsonlStore.queryError !== ""
 
             RowLayout {
                 anchors.fill: parent
@@ -43,7 +50,7 @@ Rectangle {
                     id: searchField
                     Layout.fillWidth: true
                     Layout.fillHeight: true
-                    placeholderText: "Search content..."
+                    placeholderText: filterBar.queryMode ? "tool == Bash and is_error" : "Search content..."
                     placeholderTextColor: Theme.textPlaceholder
                     font.pixelSize: Theme.fontSizeM
                     color: Theme.textEditor
@@ -81,7 +88,47 @@ Rectangle {
         Timer {
             id: searchTimer
             interval: 200
-            onTriggered: AppController.jsonlStore.textFilter = searchField.text
+            onTriggered: {
+                if (filterBar.queryMode)
+                    AppController.jsonlStore.query = searchField.text
+                else
+                    AppController.jsonlStore.textFilter = searchField.text
+            }
+        }
+
+        // Query toggle
+        Rectangle {
+            width: queryLabel.implicitWidth + 12
+            height: 22; radius: 11
+            color: filterBar.queryMode ? Theme.bgActive : Theme.bgButton
+            border.color: filterBar.queryMode ? Theme.accentPurple : Theme.border
+            border.width: 1
+            ToolTip.text: "Query fields: role, tool, model, sessionId, uuid, parentUuid,\n"
+                          + "line, timestamp, is_error, tool_use.\n"
+                          + "Operators: = != ~ < <= > >= between, and / or / not"
+            ToolTip.visible: queryMa.containsMouse
+            ToolTip.delay: 400
+
+            Label {
+                id: queryLabel
+                anchors.centerIn: parent
+                text: "{ } query"
+                font.pixelSize: Theme.fontSizeS
+                color: filterBar.queryMode ? Theme.textWhite : Theme.textMuted
+            }
+            MouseArea {
+                id: queryMa
+                anchors.fill: parent
+                hoverEnabled: true
+                cursorShape: Qt.PointingHandCursor
+                onClicked: {
+                    filterBar.queryMode = !filterBar.queryMode
+                    searchTimer.stop()
+                    searchField.text = ""
+                    AppController.jsonlStore.textFilter = ""
+                    AppController.jsonlStore.query = ""
+                }
+            }
         }
 
         // Separator
@@ -167,5 +214,32 @@ Rectangle {
                 onClicked: AppController.jsonlStore.toolUseOnly = !AppController.jsonlStore.toolUseOnly
             }
         }
+
+        // Follow toggle — picks up lines appended to the file while it is open
+        Rectangle {
+            width: followLabel.implicitWidth + 12
+            height: 22; radius: 11
+            color: AppController.jsonlStore.following ? Theme.bgActive : Theme.bgButton
+            border.color: AppController.jsonlStore.following ? Theme.accentGreen : Theme.border
+            border.width: 1
+            ToolTip.text: "Follow appended lines"
+            ToolTip.visible: followMa.containsMouse
+            ToolTip.delay: 400
+
+            Label {
+                id: followLabel
+                anchors.centerIn: parent
+                text: "\u25CF live"
+                font.pixelSize: Theme.fontSizeS
+                color: AppController.jsonlStore.following ? Theme.textWhite : Theme.textMuted
+            }
+            MouseArea {
+                id: followMa
+                anchors.fill: parent
+                hoverEnabled: true
+                cursorShape: Qt.PointingHandCursor
+                onClicked: AppController.jsonlStore.following = !AppController.jsonlStore.following
+            }
+        }
     }
 }
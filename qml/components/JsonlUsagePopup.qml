@@ -0,0 +1,211 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+import BlockSmith
+
+Dialog {
+    id: usageDialog
+
+    parent: Overlay.overlay
+    anchors.centerIn: parent
+    width: Math.min(parent.width * 0.8, 960)
+    height: Math.min(parent.height * 0.75, 600)
+
+    modal: true
+    title: "Token Usage — " + usageDialog.sourceLabel
+    standardButtons: Dialog.Close
+
+    // JsonlUsageModel: the open transcript's or AppController.usageAudit
+    property var usageModel: null
+    property string sourceLabel: ""
+
+    onClosed: {
+        if (usageModel === AppController.usageAudit)
+            usageModel.cancel()
+    }
+
+    function showTranscript() {
+        usageModel = AppController.jsonlStore.usage
+        sourceLabel = AppController.jsonlStore.filePath.replace(/\\/g, "/").split("/").pop()
+        open()
+    }
+
+    function showFolder(folderPath) {
+        usageModel = AppController.usageAudit
+        sourceLabel = folderPath.replace(/\\/g, "/").split("/").pop()
+        AppController.usageAudit.analyzeFolder(folderPath)
+        open()
+    }
+
+    function formatTokens(n) {
+        if (n >= 1e9) return (n / 1e9).toFixed(2) + "B"
+        if (n >= 1e6) return (n / 1e6).toFixed(2) + "M"
+        if (n >= 1e3) return (n / 1e3).toFixed(1) + "K"
+        return String(n)
+    }
+
+    // "unpriced" when no model in the group has a known price; a trailing
+    // "+" when some of its tokens were left out of the sum
+    function formatCost(c, unpricedTokens) {
+        if (unpricedTokens > 0 && c === 0)
+            return "unpriced"
+        return "$" + c.toFixed(c >= 100 ? 0 : 2) + (unpricedTokens > 0 ? "+" : "")
+    }
+
+    readonly property var columns: [
+        { title: "In",          role: "inputTokens" },
+        { title: "Out",         role: "outputTokens" },
+        { title: "Cache write", role: "cacheCreationTokens" },
+        { title: "Cache read",  role: "cacheReadTokens" },
+        { title: "Msgs",        role: "messages" },
+        { title: "Tools",       role: "toolCalls" }
+    ]
+    readonly property int numWidth: 84
+
+    contentItem: ColumnLayout {
+        spacing: Theme.sp8
+
+        // Group-by pills and totals
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: Theme.sp4
+
+            Repeater {
+                model: ["model", "session", "tool"]
+                delegate: Rectangle {
+                    required property string modelData
+                    readonly property bool active: usageDialog.usageModel
+                                                   && usageDialog.usageModel.groupBy === modelData
+                    width: groupLabel.implicitWidth + 16
+                    height: 22; radius: 11
+                    color: active ? Theme.bgActive : Theme.bgButton
+                    border.color: active ? Theme.accent : Theme.border
+                    border.width: 1
+
+                    Label {
+                        id: groupLabel
+                        anchors.centerIn: parent
+                        text: parent.modelData
+                        font.pixelSize: Theme.fontSizeS
+                        color: parent.active ? Theme.textWhite : Theme.textSecondary
+                    }
+                    MouseArea {
+                        anchors.fill: parent
+                        cursorShape: Qt.PointingHandCursor
+                        onClicked: usageDialog.usageModel.groupBy = parent.modelData
+                    }
+                }
+            }
+
+            BusyIndicator {
+                visible: usageDialog.usageModel && usageDialog.usageModel.busy
+                running: visible
+                Layout.preferredWidth: 20
+                Layout.preferredHeight: 20
+            }
+
+            Item { Layout.fillWidth: true }
+
+            Label {
+                text: {
+                    if (!usageDialog.usageModel) return ""
+                    let t = usageDialog.usageModel.totals
+                    let files = usageDialog.usageModel.fileCount
+                    return (files > 0 ? files + " files · " : "")
+                           + usageDialog.formatTokens(t.inputTokens + t.cacheCreationTokens + t.cacheReadTokens)
+                           + " in · " + usageDialog.formatTokens(t.outputTokens) + " out · "
+                           + usageDialog.formatCost(t.cost, t.unpricedTokens)
+                }
+                font.pixelSize: Theme.fontSizeM
+                color: Theme.textPrimary
+            }
+        }
+
+        // Column headers
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 0
+
+            Label {
+                text: "Name"
+                Layout.fillWidth: true
+                font.pixelSize: Theme.fontSizeS
+                color: Theme.textMuted
+            }
+            Repeater {
+                model: usageDialog.columns
+                delegate: Label {
+                    required property var modelData
+                    text: modelData.title
+                    Layout.preferredWidth: usageDialog.numWidth
+                    horizontalAlignment: Text.AlignRight
+                    font.pixelSize: Theme.fontSizeS
+                    color: Theme.textMuted
+                }
+            }
+            Label {
+                text: "Cost"
+                Layout.preferredWidth: usageDialog.numWidth
+                horizontalAlignment: Text.AlignRight
+                font.pixelSize: Theme.fontSizeS
+                color: Theme.textMuted
+            }
+        }
+
+        Rectangle { Layout.fillWidth: true; height: 1; color: Theme.border }
+
+        ListView {
+            id: usageList
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            clip: true
+            model: usageDialog.usageModel
+            ScrollBar.vertical: ScrollBar {}
+
+            delegate: RowLayout {
+                id: usageRow
+                required property var model
+                width: usageList.width
+                spacing: 0
+
+                Label {
+                    text: usageRow.model.name
+                    Layout.fillWidth: true
+                    elide: Text.ElideMiddle
+                    font.family: Theme.fontMono
+                    font.pixelSize: Theme.fontSizeM
+                    color: Theme.textPrimary
+                }
+                Repeater {
+                    model: usageDialog.columns
+                    delegate: Label {
+                        required property var modelData
+                        text: usageDialog.formatTokens(usageRow.model[modelData.role])
+                        Layout.preferredWidth: usageDialog.numWidth
+                        horizontalAlignment: Text.AlignRight
+                        font.family: Theme.fontMono
+                        font.pixelSize: Theme.fontSizeM
+                        color: Theme.textSecondary
+                    }
+                }
+                Label {
+                    text: usageDialog.formatCost(usageRow.model.cost, usageRow.model.unpricedTokens)
+                    Layout.preferredWidth: usageDialog.numWidth
+                    horizontalAlignment: Text.AlignRight
+                    font.family: Theme.fontMono
+                    font.pixelSize: Theme.fontSizeM
+                    color: Theme.textPrimary
+                }
+            }
+        }
+
+        Label {
+            text: "Costs use list prices per model id; cached tokens bill at cache rates. "
+                  + "Models without a known price show as unpriced, and + marks a total that leaves them out."
+            Layout.fillWidth: true
+            wrapMode: Text.WordWrap
+            font.pixelSize: Theme.fontSizeS
+            color: Theme.textMuted
+        }
+    }
+}
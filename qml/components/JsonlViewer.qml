@@ -37,6 +37,9 @@ Rectangle {
 
                 delegate: JsonlEntryCard {
                     width: entryList.width - entryList.leftMargin - entryList.rightMargin
+                    onNavigate: function(row) {
+                        entryList.positionViewAtIndex(row, ListView.Center)
+                    }
                 }
 
                 ScrollBar.vertical: ScrollBar {
@@ -117,6 +120,38 @@ Rectangle {
 
                 Item { Layout.fillWidth: true }
 
+                // Token usage — click for the per-model / session / tool breakdown
+                Label {
+                    readonly property var totals: AppController.jsonlStore.usage.totals
+                    visible: totals.messages > 0
+                    text: usagePopup.formatTokens(totals.outputTokens) + " out \u00B7 "
+                          + usagePopup.formatCost(totals.cost, totals.unpricedTokens)
+                    font.pixelSize: Theme.fontSizeS
+                    color: usageMa.containsMouse ? Theme.textPrimary : Theme.textMuted
+                    MouseArea {
+                        id: usageMa
+                        anchors.fill: parent
+                        hoverEnabled: true
+                        cursorShape: Qt.PointingHandCursor
+                        onClicked: usagePopup.showTranscript()
+                    }
+                }
+
+                // Thread filter chip — click to show the whole transcript again
+                Label {
+                    visible: AppController.jsonlStore.threadFiltered
+                    text: "\u21F5 thread \u2715"
+                    font.pixelSize: Theme.fontSizeS
+                    color: threadMa.containsMouse ? Theme.textPrimary : Theme.accentPurple
+                    MouseArea {
+                        id: threadMa
+                        anchors.fill: parent
+                        hoverEnabled: true
+                        cursorShape: Qt.PointingHandCursor
+                        onClicked: AppController.jsonlStore.clearThreadFilter()
+                    }
+                }
+
                 Label {
                     text: {
                         let total = AppController.jsonlStore.totalCount
@@ -132,6 +167,10 @@ Rectangle {
         }
     }
 
+    JsonlUsagePopup {
+        id: usagePopup
+    }
+
     // Keyboard shortcuts
     Shortcut {
         sequence: "Ctrl+F"
@@ -15,6 +15,7 @@ Menu {
     signal fileRenameRequested(string itemPath)
     signal deleteRequested(string itemPath, string itemName)
     signal cutPathChanged(string newPath)
+    signal usageAnalysisRequested(string folderPath)
 
     // nodeType: 0=project, 1=dir, 2=file
     function targetDir() {
@@ -106,6 +107,18 @@ Menu {
         }
     }
 
+    MenuSeparator {
+        visible: contextMenu.targetNodeType !== 2
+        height: visible ? implicitHeight : 0
+    }
+
+    MenuItem {
+        text: "Analyze Transcript Usage..."
+        visible: contextMenu.targetNodeType !== 2
+        height: visible ? implicitHeight : 0
+        onTriggered: contextMenu.usageAnalysisRequested(contextMenu.targetPath)
+    }
+
     MenuSeparator {}
 
     MenuItem {
@@ -292,6 +292,7 @@ Rectangle {
                 onFolderNewRequested: function(dirPath) { navPanel.folderNewRequested(dirPath) }
                 onFileRenameRequested: function(itemPath) { navPanel.fileRenameRequested(itemPath) }
                 onCutPathChanged: function(newPath) { navPanel.cutItemPath = newPath }
+                onUsageAnalysisRequested: function(folderPath) { usagePopup.showFolder(folderPath) }
                 onDeleteRequested: function(itemPath, itemName) {
                     deleteDialog.itemPath = itemPath
                     deleteDialog.itemName = itemName
@@ -336,6 +337,10 @@ Rectangle {
                         console.warn("Delete failed:", err)
                 }
             }
+
+            JsonlUsagePopup {
+                id: usagePopup
+            }
         }
 
         // Separator
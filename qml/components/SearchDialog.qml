@@ -15,8 +15,15 @@ Dialog {
     title: "Search All Files"
     standardButtons: Dialog.Close
 
-    property var results: []
     property int selectedIndex: -1
+    property bool searching: false
+    property bool truncated: false
+    property bool caseSensitive: false
+    property bool wholeWord: false
+    property bool useRegex: false
+    property string errorText: ""
+
+    ListModel { id: resultsModel }
 
     function focusSearch() {
         searchInput.forceActiveFocus()
@@ -24,20 +31,40 @@ Dialog {
     }
 
     function acceptCurrent() {
-        if (selectedIndex >= 0 && selectedIndex < results.length) {
-            AppController.openFileAtLine(results[selectedIndex].filePath,
-                                         results[selectedIndex].line)
+        if (selectedIndex >= 0 && selectedIndex < resultsModel.count) {
+            let hit = resultsModel.get(selectedIndex)
+            AppController.openFileAtLine(hit.filePath, hit.line)
             searchDialog.close()
         }
     }
 
+    function clearResults() {
+        resultsModel.clear()
+        selectedIndex = -1
+        truncated = false
+        errorText = ""
+    }
+
+    function restartSearch() {
+        if (searchInput.text.length >= 2)
+            searchTimer.restart()
+    }
+
     onOpened: focusSearch()
 
     Connections {
         target: AppController
-        function onSearchResultsReady(r) {
-            searchDialog.results = r
-            searchDialog.selectedIndex = r.length > 0 ? 0 : -1
+        function onSearchResultsBatch(hits) {
+            resultsModel.append(hits)
+            if (searchDialog.selectedIndex < 0 && resultsModel.count > 0)
+                searchDialog.selectedIndex = 0
+        }
+        function onSearchFinished(truncated) {
+            searchDialog.searching = false
+            searchDialog.truncated = truncated
+        }
+        function onSearchError(message) {
+            searchDialog.errorText = message
         }
     }
 
@@ -51,8 +78,12 @@ Dialog {
             Layout.preferredHeight: 34
             color: Theme.bg
             radius: Theme.radius
-            border.color: searchInput.activeFocus ? Theme.borderFocus : Theme.border
+            border.color: searchDialog.errorText !== ""
+                          ? Theme.accentRed
+                          : searchInput.activeFocus ? Theme.borderFocus : Theme.border
             border.width: 1
+            ToolTip.text: searchDialog.errorText
+            ToolTip.visible: searchInput.activeFocus && searchDialog.errorText !== ""
 
             RowLayout {
                 anchors.fill: parent
@@ -68,7 +99,7 @@ Dialog {
                 TextField {
                     id: searchInput
                     Layout.fillWidth: true
-                    placeholderText: "Search enabled file formats..."
+                    placeholderText: "Search enabled file formats...  (path:*.md, A NEAR B)"
                     placeholderTextColor: Theme.textPlaceholder
                     font.pixelSize: Theme.fontSizeL
                     color: Theme.textPrimary
@@ -76,8 +107,8 @@ Dialog {
 
                     onTextChanged: {
                         if (text.length < 2) {
-                            searchDialog.results = []
-                            searchDialog.selectedIndex = -1
+                            searchDialog.clearResults()
+                            searchDialog.searching = false
                             searchTimer.stop()
                         } else {
                             searchTimer.restart()
@@ -86,7 +117,7 @@ Dialog {
 
                     Keys.onPressed: function(event) {
                         if (event.key === Qt.Key_Down) {
-                            if (searchDialog.results.length > 0 && searchDialog.selectedIndex < searchDialog.results.length - 1)
+                            if (searchDialog.selectedIndex < resultsModel.count - 1)
                                 searchDialog.selectedIndex++
                             event.accepted = true
                         } else if (event.key === Qt.Key_Up) {
@@ -100,8 +131,37 @@ Dialog {
                     }
                 }
 
+                SearchToggle {
+                    label: "Aa"
+                    tooltip: "Match case"
+                    checked: searchDialog.caseSensitive
+                    onToggled: { searchDialog.caseSensitive = !searchDialog.caseSensitive; searchDialog.restartSearch() }
+                }
+
+                SearchToggle {
+                    label: "W"
+                    tooltip: "Whole words"
+                    checked: searchDialog.wholeWord
+                    onToggled: { searchDialog.wholeWord = !searchDialog.wholeWord; searchDialog.restartSearch() }
+                }
+
+                SearchToggle {
+                    label: ".*"
+                    tooltip: "Regular expression"
+                    checked: searchDialog.useRegex
+                    onToggled: { searchDialog.useRegex = !searchDialog.useRegex; searchDialog.restartSearch() }
+                }
+
+                BusyIndicator {
+                    running: searchDialog.searching
+                    visible: running
+                    Layout.preferredWidth: 18
+                    Layout.preferredHeight: 18
+                }
+
                 Label {
-                    text: searchDialog.results.length + " result" + (searchDialog.results.length !== 1 ? "s" : "")
+                    text: resultsModel.count + (searchDialog.truncated ? "+" : "")
+                          + " result" + (resultsModel.count !== 1 ? "s" : "")
                     font.pixelSize: Theme.fontSizeXS
                     color: Theme.textMuted
                     visible: searchInput.text.length >= 2
@@ -113,7 +173,10 @@ Dialog {
             id: searchTimer
             interval: 300
             onTriggered: {
-                AppController.searchFiles(searchInput.text)
+                searchDialog.clearResults()
+                searchDialog.searching = true
+                AppController.searchFiles(searchInput.text, searchDialog.caseSensitive,
+                                          searchDialog.wholeWord, searchDialog.useRegex)
             }
         }
 
@@ -123,11 +186,14 @@ Dialog {
             Layout.fillWidth: true
             Layout.fillHeight: true
             clip: true
-            model: searchDialog.results
+            model: resultsModel
             currentIndex: searchDialog.selectedIndex
             spacing: 1
 
             delegate: Rectangle {
+                id: resultRow
+                required property var model
+                required property int index
                 width: ListView.view.width
                 height: resultLayout.implicitHeight + 8
                 color: index === searchDialog.selectedIndex
@@ -141,7 +207,7 @@ Dialog {
                     hoverEnabled: true
                     cursorShape: Qt.PointingHandCursor
                     onClicked: {
-                        AppController.openFileAtLine(modelData.filePath, modelData.line)
+                        AppController.openFileAtLine(resultRow.model.filePath, resultRow.model.line)
                         searchDialog.close()
                     }
                 }
@@ -157,7 +223,7 @@ Dialog {
                         spacing: 2
 
                         Label {
-                            text: modelData.text
+                            text: resultRow.model.text
                             font.family: Theme.fontMono
                             font.pixelSize: Theme.fontSizeM
                             color: Theme.textPrimary
@@ -166,7 +232,7 @@ Dialog {
                         }
 
                         Label {
-                            text: modelData.filePath
+                            text: resultRow.model.filePath
                             font.pixelSize: Theme.fontSizeS
                             color: Theme.textMuted
                             elide: Text.ElideMiddle
@@ -175,7 +241,7 @@ Dialog {
                     }
 
                     Label {
-                        text: ":" + modelData.line
+                        text: ":" + resultRow.model.line
                         font.family: Theme.fontMono
                         font.pixelSize: Theme.fontSizeXS
                         color: Theme.accent
@@ -186,8 +252,8 @@ Dialog {
             // Empty state
             Label {
                 anchors.centerIn: parent
-                visible: parent.count === 0 && searchInput.text.length >= 2
-                text: "No results found."
+                visible: parent.count === 0 && searchInput.text.length >= 2 && !searchDialog.searching
+                text: searchDialog.errorText !== "" ? searchDialog.errorText : "No results found."
                 font.pixelSize: Theme.fontSizeL
                 color: Theme.textMuted
             }
@@ -201,4 +267,41 @@ Dialog {
             }
         }
     }
+
+    // --- Inline components ---
+
+    component SearchToggle: Rectangle {
+        property string label: ""
+        property string tooltip: ""
+        property bool checked: false
+        signal toggled()
+
+        Layout.preferredWidth: Math.max(24, toggleLabel.implicitWidth + 10)
+        Layout.preferredHeight: 22
+        radius: Theme.radius
+        color: checked ? Theme.bgActive : (toggleMa.containsMouse ? Theme.bgButtonHov : "transparent")
+        border.color: checked ? Theme.accent : "transparent"
+        border.width: 1
+
+        ToolTip.text: tooltip
+        ToolTip.visible: toggleMa.containsMouse
+        ToolTip.delay: 400
+
+        Label {
+            id: toggleLabel
+            anchors.centerIn: parent
+            text: parent.label
+            font.family: Theme.fontMono
+            font.pixelSize: Theme.fontSizeXS
+            color: parent.checked ? Theme.textWhite : Theme.textMuted
+        }
+
+        MouseArea {
+            id: toggleMa
+            anchors.fill: parent
+            hoverEnabled: true
+            cursorShape: Qt.PointingHandCursor
+            onClicked: parent.toggled()
+        }
+    }
 }
@@ -25,6 +25,8 @@ ColumnLayout {
         searchTxtCheck.checked = AppController.configManager.searchIncludePlaintext
         searchPdfCheck.checked = AppController.configManager.searchIncludePdf
         searchDocxCheck.checked = AppController.configManager.searchIncludeDocx
+        searchMaxResultsSpin.value = AppController.configManager.searchMaxResults
+        searchMaxPerFileSpin.value = AppController.configManager.searchMaxHitsPerFile
     }
 
     function saveToConfig() {
@@ -43,6 +45,8 @@ ColumnLayout {
         AppController.configManager.searchIncludePlaintext = searchTxtCheck.checked
         AppController.configManager.searchIncludePdf = searchPdfCheck.checked
         AppController.configManager.searchIncludeDocx = searchDocxCheck.checked
+        AppController.configManager.searchMaxResults = searchMaxResultsSpin.value
+        AppController.configManager.searchMaxHitsPerFile = searchMaxPerFileSpin.value
     }
 
     Label {
@@ -219,6 +223,32 @@ ColumnLayout {
         }
     }
 
+    RowLayout {
+        spacing: Theme.sp8
+
+        Label { text: "Max results:" }
+
+        SpinBox {
+            id: searchMaxResultsSpin
+            from: 50
+            to: 100000
+            stepSize: 500
+            value: 2000
+            editable: true
+        }
+
+        Label { text: "Per file:" }
+
+        SpinBox {
+            id: searchMaxPerFileSpin
+            from: 1
+            to: 10000
+            stepSize: 10
+            value: 100
+            editable: true
+        }
+    }
+
     RowLayout {
         spacing: Theme.sp8
 
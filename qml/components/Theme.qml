@@ -56,6 +56,8 @@ QtObject {
     readonly property color diffFileBorder:     isDark ? "#806020" : "#ffcc02"
     readonly property color diffAddedBg:        isDark ? "#1a3320" : "#c8e6c9"
     readonly property color diffRemovedBg:      isDark ? "#3d1a1a" : "#ffcdd2"
+    readonly property color diffAddedWordBg:    isDark ? "#2e6b3a" : "#81c784"
+    readonly property color diffRemovedWordBg:  isDark ? "#7a2e2e" : "#ef9a9a"
     readonly property color categoryAudit:      isDark ? "#5a3d3d" : "#ffcdd2"
     readonly property color categoryReview:     isDark ? "#3d5a3d" : "#c8e6c9"
     readonly property color categoryDebug:      isDark ? "#5a4d3d" : "#ffe0b2"
@@ -40,10 +40,13 @@ AppController::AppController(QObject *parent)
         QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/prompts.db.json", this))
     , m_syncEngine(new SyncEngine(m_blockStore, m_projectTreeModel, this))
     , m_imageHandler(new ImageHandler(this))
-    , m_jsonlStore(new JsonlStore(this))
+    , m_jsonlStore(new JsonlStore(
+        QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/jsonl-cache", this))
+    , m_usageAudit(new JsonlUsageModel(this))
     , m_exportManager(new ExportManager(m_md4cRenderer, this))
     , m_tabModel(new TabModel(m_blockStore, m_configManager, this))
-    , m_searchManager(new SearchManager(m_projectTreeModel, m_configManager, this))
+    , m_searchManager(new SearchManager(m_projectTreeModel, m_configManager,
+        QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/search-index", this))
 {
     m_fileManager = new FileManager(m_configManager, this);
     m_fileManager->setTabModel(m_tabModel);
@@ -54,9 +57,17 @@ AppController::AppController(QObject *parent)
     connect(m_projectScanner, &ProjectScanner::scanComplete,
             this, [this](int count) {
                 m_syncEngine->rebuildIndex();
+                m_searchManager->syncIndex();
                 emit scanComplete(count);
             });
 
+    // Files rewritten by block push or merge: refresh their search index entries
+    connect(m_syncEngine, &SyncEngine::filesWritten,
+            this, [this](const QStringList &filePaths) {
+                for (const QString &path : filePaths)
+                    m_searchManager->refreshIndexedFile(path);
+            });
+
     // After file operations: clean up JSONL viewer if file gone, then rescan
     connect(m_fileManager, &FileManager::fileOperationComplete,
             this, [this]() {
@@ -76,8 +87,12 @@ AppController::AppController(QObject *parent)
             this, &AppController::openFile);
 
     // Forward SearchManager signals
-    connect(m_searchManager, &SearchManager::searchResultsReady,
-            this, &AppController::searchResultsReady);
+    connect(m_searchManager, &SearchManager::searchResultsBatch,
+            this, &AppController::searchResultsBatch);
+    connect(m_searchManager, &SearchManager::searchFinished,
+            this, &AppController::searchFinished);
+    connect(m_searchManager, &SearchManager::searchError,
+            this, &AppController::searchError);
 
     // When active tab changes, reconnect signals and update dependent managers
     connect(m_tabModel, &TabModel::activeDocumentChanged, this, [this]() {
@@ -127,9 +142,12 @@ AppController::AppController(QObject *parent)
 
 void AppController::connectActiveDocument(Document *doc)
 {
-    // Rebuild block index after document save
+    // Re-index just the saved file (blocks and workspace search)
     m_docConnections.append(
-        connect(doc, &Document::saved, m_syncEngine, &SyncEngine::rebuildIndex));
+        connect(doc, &Document::saved, this, [this, doc]() {
+            m_syncEngine->updateFile(doc->filePath(), doc->rawContent());
+            m_searchManager->refreshIndexedFile(doc->filePath());
+        }));
 
     // Deferred line navigation
     m_docConnections.append(
@@ -192,6 +210,7 @@ SyncEngine *AppController::syncEngine() const { return m_syncEngine; }
 FileManager *AppController::fileManager() const { return m_fileManager; }
 ImageHandler *AppController::imageHandler() const { return m_imageHandler; }
 JsonlStore *AppController::jsonlStore() const { return m_jsonlStore; }
+JsonlUsageModel *AppController::usageAudit() const { return m_usageAudit; }
 ExportManager *AppController::exportManager() const { return m_exportManager; }
 TabModel *AppController::tabModel() const { return m_tabModel; }
 QStringList AppController::highlightedFiles() const { return m_highlightedFiles; }
@@ -273,7 +292,12 @@ bool AppController::canGoForward() const { return m_navigationManager->canGoForw
 
 // --- Search forwarding ---
 
-void AppController::searchFiles(const QString &query) { m_searchManager->searchFiles(query); }
+void AppController::searchFiles(const QString &query, bool caseSensitive, bool wholeWord,
+                                bool regex)
+{
+    m_searchManager->searchFiles(query, caseSensitive, wholeWord, regex);
+}
+
 bool AppController::fileExists(const QString &path) const { return QFileInfo::exists(path); }
 QStringList AppController::getAllFiles() const { return m_searchManager->getAllFiles(); }
 QVariantList AppController::fuzzyFilterFiles(const QString &query) const { return m_searchManager->fuzzyFilterFiles(query); }
@@ -37,6 +37,7 @@ class AppController : public QObject
     Q_PROPERTY(FileManager* fileManager READ fileManager CONSTANT)
     Q_PROPERTY(ImageHandler* imageHandler READ imageHandler CONSTANT)
     Q_PROPERTY(JsonlStore* jsonlStore READ jsonlStore CONSTANT)
+    Q_PROPERTY(JsonlUsageModel* usageAudit READ usageAudit CONSTANT)
     Q_PROPERTY(ExportManager* exportManager READ exportManager CONSTANT)
     Q_PROPERTY(TabModel* tabModel READ tabModel CONSTANT)
     Q_PROPERTY(QStringList highlightedFiles READ highlightedFiles NOTIFY highlightedFilesChanged)
@@ -59,11 +60,13 @@ public:
     FileManager *fileManager() const;
     ImageHandler *imageHandler() const;
     JsonlStore *jsonlStore() const;
+    JsonlUsageModel *usageAudit() const;
     ExportManager *exportManager() const;
     TabModel *tabModel() const;
     QStringList highlightedFiles() const;
 
-    Q_INVOKABLE void searchFiles(const QString &query);
+    Q_INVOKABLE void searchFiles(const QString &query, bool caseSensitive = false,
+                                 bool wholeWord = false, bool regex = false);
     Q_INVOKABLE void revealInExplorer(const QString &path) const;
     Q_INVOKABLE void copyToClipboard(const QString &text) const;
     Q_INVOKABLE QStringList fileTriggerFiles() const;
@@ -85,7 +88,9 @@ public:
 signals:
     void scanComplete(int projectCount);
     void highlightedFilesChanged();
-    void searchResultsReady(const QVariantList &results);
+    void searchResultsBatch(const QVariantList &hits);
+    void searchFinished(bool truncated);
+    void searchError(const QString &message);
     void navHistoryChanged();
     void navigateToLineRequested(int lineNumber);
     void currentDocumentChanged();
@@ -109,6 +114,7 @@ private:
     FileManager *m_fileManager = nullptr;
     ImageHandler *m_imageHandler = nullptr;
     JsonlStore *m_jsonlStore = nullptr;
+    JsonlUsageModel *m_usageAudit = nullptr;   // multi-transcript usage scans
     ExportManager *m_exportManager = nullptr;
     TabModel *m_tabModel = nullptr;
     NavigationManager *m_navigationManager = nullptr;
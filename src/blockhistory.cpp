@@ -0,0 +1,245 @@
+#include "blockhistory.h"
+#include "linediff.h"
+#include "mappedfile.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QTimeZone>
+#include <algorithm>
+
+namespace {
+
+constexpr quint32 kMagic = 0x42534856;        // "BSHV"
+constexpr quint32 kVersion = 1;
+constexpr qint64 kHeaderSize = 8;
+constexpr qint64 kRecordHeaderSize = 16;
+constexpr auto kStreamVersion = QDataStream::Qt_6_0;
+
+enum RecordKind : quint32 { Snapshot = 1, Delta = 2 };
+enum DeltaOp : quint8 { Copy = 0, Skip = 1, Insert = 2 };
+
+QStringList splitLines(const QString &text)
+{
+    return text.split(QLatin1Char('\n'));
+}
+
+QByteArray encodeSnapshot(const QString &text)
+{
+    return qCompress(text.toUtf8());
+}
+
+// Ops that turn `newer` into `older`: copy or skip lines of `newer`, or
+// insert lines only `older` has
+QByteArray encodeDelta(const QString &newer, const QString &older)
+{
+    const QStringList a = splitLines(newer);
+    const QStringList b = splitLines(older);
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(kStreamVersion);
+    for (const LineDiff::Run &run : LineDiff::diff(a, b)) {
+        if (run.equal) {
+            out << quint8(Copy) << quint32(run.aCount);
+            continue;
+        }
+        if (run.aCount > 0)
+            out << quint8(Skip) << quint32(run.aCount);
+        if (run.bCount > 0) {
+            out << quint8(Insert) << quint32(run.bCount);
+            for (int i = 0; i < run.bCount; ++i)
+                out << b[run.bStart + i].toUtf8();
+        }
+    }
+    return bytes;
+}
+
+std::optional<QString> applyDelta(const QByteArray &delta, const QString &newer)
+{
+    const QStringList a = splitLines(newer);
+    QStringList out;
+    qsizetype pos = 0;
+    QDataStream in(delta);
+    in.setVersion(kStreamVersion);
+    while (!in.atEnd()) {
+        quint8 op = 0;
+        quint32 count = 0;
+        in >> op >> count;
+        if (in.status() != QDataStream::Ok)
+            return std::nullopt;
+        if (op == Insert) {
+            for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                QByteArray line;
+                in >> line;
+                out.append(QString::fromUtf8(line));
+            }
+            continue;
+        }
+        if (op > Insert || pos + count > a.size())
+            return std::nullopt;
+        if (op == Copy)
+            out += a.mid(pos, count);
+        pos += count;
+    }
+    if (in.status() != QDataStream::Ok || pos != a.size())
+        return std::nullopt;
+    return out.join(QLatin1Char('\n'));
+}
+
+} // namespace
+
+BlockHistory::BlockHistory(const QString &dir)
+    : m_dir(dir)
+{
+}
+
+QString BlockHistory::logPath(const QString &blockId) const
+{
+    return m_dir + QLatin1Char('/') + blockId + QStringLiteral(".hist");
+}
+
+BlockHistory::Log &BlockHistory::log(const QString &blockId) const
+{
+    auto it = m_logs.find(blockId);
+    if (it != m_logs.end())
+        return it.value();
+
+    Log loaded;
+    MappedFile file;
+    if (file.open(logPath(blockId)) && file.size() >= kHeaderSize) {
+        QDataStream header(file.bytes(0, kHeaderSize));
+        header.setVersion(kStreamVersion);
+        quint32 magic = 0, version = 0;
+        header >> magic >> version;
+        if (magic == kMagic && version == kVersion) {
+            // Collect record headers up to the first incomplete record
+            qint64 pos = kHeaderSize;
+            while (pos + kRecordHeaderSize <= file.size()) {
+                QDataStream in(file.bytes(pos, kRecordHeaderSize));
+                in.setVersion(kStreamVersion);
+                Record record;
+                in >> record.kind >> record.size >> record.savedAt;
+                record.offset = pos + kRecordHeaderSize;
+                if ((record.kind != Snapshot && record.kind != Delta)
+                    || record.offset + record.size > file.size())
+                    break;
+                loaded.records.append(record);
+                pos = record.offset + record.size;
+            }
+            loaded.end = pos;
+        }
+    }
+    return *m_logs.insert(blockId, loaded);
+}
+
+bool BlockHistory::append(const QString &blockId, const QString &previous,
+                          const QDateTime &savedAt, const QString &current)
+{
+    Log &entry = log(blockId);
+
+    // Snapshot when a delta would not save anything, and often enough to
+    // bound the delta chain behind any version
+    const QByteArray snapshot = encodeSnapshot(previous);
+    QByteArray payload = encodeDelta(current, previous);
+    quint32 kind = Delta;
+    const int tail = std::min<int>(entry.records.size(), kSnapshotInterval - 1);
+    const bool chainFull = tail == kSnapshotInterval - 1
+        && std::all_of(entry.records.cend() - tail, entry.records.cend(),
+                       [](const Record &r) { return r.kind == Delta; });
+    if (chainFull || payload.size() >= snapshot.size()) {
+        payload = snapshot;
+        kind = Snapshot;
+    }
+
+    QDir().mkpath(m_dir);
+    QFile file(logPath(blockId));
+    if (!file.open(QIODevice::ReadWrite)) {
+        qWarning("BlockHistory: could not write %s", qPrintable(file.fileName()));
+        return false;
+    }
+
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(kStreamVersion);
+    // Start at the end of the last complete record, dropping any torn tail
+    qint64 start = entry.end;
+    if (entry.end < kHeaderSize) {
+        out << kMagic << kVersion;
+        entry = Log();
+        entry.end = kHeaderSize;
+        start = 0;
+    }
+    Record record;
+    record.kind = kind;
+    record.size = quint32(payload.size());
+    record.savedAt = savedAt.toMSecsSinceEpoch();
+    record.offset = entry.end + kRecordHeaderSize;
+    out << record.kind << record.size << record.savedAt;
+    bytes += payload;
+
+    if (!file.resize(start) || !file.seek(start) || file.write(bytes) != bytes.size()
+        || !file.flush()) {
+        qWarning("BlockHistory: could not write %s", qPrintable(file.fileName()));
+        m_logs.remove(blockId);
+        return false;
+    }
+
+    entry.records.append(record);
+    entry.end = record.offset + record.size;
+    return true;
+}
+
+QVector<BlockHistory::Version> BlockHistory::versions(const QString &blockId) const
+{
+    const Log &entry = log(blockId);
+    QVector<Version> out;
+    out.reserve(entry.records.size());
+    for (int i = 0; i < entry.records.size(); ++i) {
+        const Record &r = entry.records[i];
+        out.append({ i, QDateTime::fromMSecsSinceEpoch(r.savedAt, QTimeZone::UTC),
+                     r.kind == Snapshot });
+    }
+    return out;
+}
+
+int BlockHistory::versionCount(const QString &blockId) const
+{
+    return static_cast<int>(log(blockId).records.size());
+}
+
+std::optional<QString> BlockHistory::materialize(const QString &blockId, int index,
+                                                const QString &current) const
+{
+    const Log &entry = log(blockId);
+    const int count = static_cast<int>(entry.records.size());
+    if (index < 0 || index > count)
+        return std::nullopt;
+    if (index == count)
+        return current;
+
+    // Nearest snapshot at or after `index`, else the current content...
+    int start = index;
+    while (start < count && entry.records[start].kind != Snapshot)
+        ++start;
+
+    MappedFile file;
+    if (!file.open(logPath(blockId)) || file.size() < entry.end)
+        return std::nullopt;
+    auto payload = [&](int i) {
+        return file.bytes(entry.records[i].offset, entry.records[i].size);
+    };
+
+    std::optional<QString> text = current;
+    if (start < count)
+        text = QString::fromUtf8(qUncompress(payload(start)));
+    // ...then walk the reverse deltas back down to it
+    for (int i = start - 1; i >= index && text; --i)
+        text = applyDelta(payload(i), *text);
+    return text;
+}
+
+void BlockHistory::remove(const QString &blockId)
+{
+    m_logs.remove(blockId);
+    QFile::remove(logPath(blockId));
+}
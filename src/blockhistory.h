@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <optional>
+
+// Append-only version history for registry blocks, one log file per block
+// in `dir`. The newest version is always the block's current content in
+// BlockStore; the log holds everything before it. Version i is stored as a
+// reverse line delta that rebuilds it from version i+1, or as a compressed
+// full snapshot when the delta would not be smaller or when the previous
+// kSnapshotInterval - 1 records were all deltas. Reading version i costs
+// one snapshot (or the current content) plus fewer than kSnapshotInterval
+// deltas, read from a memory-mapped log.
+//
+// Layout: 8-byte header (magic, version), then records of
+// [kind, payload size, savedAt] + payload. A torn record at the end is
+// ignored and overwritten by the next append.
+class BlockHistory
+{
+public:
+    static constexpr int kSnapshotInterval = 16;
+
+    struct Version {
+        int index = 0;
+        QDateTime savedAt;         // when this version became current
+        bool snapshot = false;
+    };
+
+    explicit BlockHistory(const QString &dir);
+
+    // Record that the block changed away from `previous`, which had been
+    // current since `savedAt`; `current` is what replaces it
+    bool append(const QString &blockId, const QString &previous, const QDateTime &savedAt,
+                const QString &current);
+
+    // Versions before the current one, oldest first
+    QVector<Version> versions(const QString &blockId) const;
+    int versionCount(const QString &blockId) const;
+
+    // Content of version `index`; index == versionCount() gives `current`.
+    // Empty when the index is out of range or the log is damaged.
+    std::optional<QString> materialize(const QString &blockId, int index,
+                                       const QString &current) const;
+
+    void remove(const QString &blockId);
+
+private:
+    struct Record {
+        qint64 offset = 0;         // payload start
+        quint32 size = 0;
+        quint32 kind = 0;
+        qint64 savedAt = 0;        // ms since epoch
+    };
+    struct Log {
+        QVector<Record> records;
+        qint64 end = 0;            // end of the last complete record
+    };
+
+    QString logPath(const QString &blockId) const;
+    Log &log(const QString &blockId) const;   // loads on first use
+
+    QString m_dir;
+    mutable QHash<QString, Log> m_logs;
+};
@@ -0,0 +1,175 @@
+#include "blockscanner.h"
+
+#include <QHash>
+
+namespace {
+
+constexpr QStringView kCommentOpen = u"<!--";
+constexpr QStringView kCommentClose = u"-->";
+constexpr QStringView kBlockTag = u"block:";
+constexpr QStringView kEndTag = u"/block:";
+constexpr QStringView kIdTag = u"[id:";
+
+bool isBlank(QChar c) { return c == u' ' || c == u'\t'; }
+bool isHex(QChar c) { return (c >= u'0' && c <= u'9') || (c >= u'a' && c <= u'f'); }
+
+qsizetype skipBlanks(QStringView text, qsizetype i)
+{
+    while (i < text.size() && isBlank(text[i]))
+        ++i;
+    return i;
+}
+
+qsizetype skipHex(QStringView text, qsizetype i)
+{
+    while (i < text.size() && isHex(text[i]))
+        ++i;
+    return i;
+}
+
+// Position after `tag` at i, or -1
+qsizetype expect(QStringView text, qsizetype i, QStringView tag)
+{
+    return text.sliced(i).startsWith(tag) ? i + tag.size() : -1;
+}
+
+// `<!-- block: Name [id:hex] -->` + line break at `pos`. Fills start,
+// contentStart, id and name.
+bool parseOpen(QStringView text, qsizetype pos, BlockScanner::Span &span)
+{
+    qsizetype i = expect(text, skipBlanks(text, pos + kCommentOpen.size()), kBlockTag);
+    if (i < 0)
+        return false;
+
+    const qsizetype nameStart = skipBlanks(text, i);
+    qsizetype lineEnd = text.indexOf(u'\n', nameStart);
+    if (lineEnd < 0)
+        return false;   // no line break, so no content and no closing marker
+
+    // The name runs up to the first "[id:hex]" that closes the comment. Only
+    // this line is searched, so a marker without an id stays cheap.
+    const QStringView line = text.first(lineEnd);
+    for (qsizetype tag = line.indexOf(kIdTag, nameStart); tag >= 0;
+         tag = line.indexOf(kIdTag, tag + 1)) {
+        const qsizetype idStart = tag + kIdTag.size();
+        const qsizetype idEnd = skipHex(text, idStart);
+        if (idEnd == idStart || idEnd >= text.size() || text[idEnd] != u']')
+            continue;
+        i = expect(text, skipBlanks(text, idEnd + 1), kCommentClose);
+        if (i < 0)
+            continue;
+        if (i < text.size() && text[i] == u'\r')
+            ++i;
+        if (i != lineEnd)
+            continue;
+
+        qsizetype nameEnd = tag;
+        while (nameEnd > nameStart && isBlank(text[nameEnd - 1]))
+            --nameEnd;
+        span.start = pos;
+        span.contentStart = lineEnd + 1;
+        span.id = text.sliced(idStart, idEnd - idStart);
+        span.name = text.sliced(nameStart, nameEnd - nameStart);
+        return true;
+    }
+    return false;
+}
+
+// `<!-- /block:hex -->` at `pos`; returns its end, or -1. Sets `id`.
+qsizetype parseClose(QStringView text, qsizetype pos, QStringView &id)
+{
+    const qsizetype idStart = expect(text, skipBlanks(text, pos + kCommentOpen.size()), kEndTag);
+    if (idStart < 0)
+        return -1;
+    const qsizetype idEnd = skipHex(text, idStart);
+    if (idEnd == idStart)
+        return -1;
+    const qsizetype end = expect(text, skipBlanks(text, idEnd), kCommentClose);
+    if (end >= 0)
+        id = text.sliced(idStart, idEnd - idStart);
+    return end;
+}
+
+void setClose(QStringView text, qsizetype closeStart, qsizetype end, BlockScanner::Span &span)
+{
+    // Content excludes the line break in front of the closing marker
+    qsizetype contentEnd = closeStart;
+    if (contentEnd > span.contentStart && text[contentEnd - 1] == u'\n') {
+        --contentEnd;
+        if (contentEnd > span.contentStart && text[contentEnd - 1] == u'\r')
+            --contentEnd;
+    }
+    span.contentEnd = contentEnd;
+    span.closeStart = closeStart;
+    span.end = end;
+}
+
+} // namespace
+
+namespace BlockScanner {
+
+QList<Span> scan(QStringView text)
+{
+    // One pass collects every opening and closing marker...
+    QList<Span> opens;
+    QHash<QStringView, QList<QPair<qsizetype, qsizetype>>> closes;   // id -> (start, end)
+    for (qsizetype pos = text.indexOf(kCommentOpen); pos >= 0;
+         pos = text.indexOf(kCommentOpen, pos + 1)) {
+        Span span;
+        QStringView id;
+        if (parseOpen(text, pos, span)) {
+            opens.append(span);
+        } else {
+            const qsizetype end = parseClose(text, pos, id);
+            if (end >= 0)
+                closes[id].append({pos, end});
+        }
+    }
+
+    // ...then each top-level opening marker takes the next closing marker
+    // with its id. Per-id cursors only move forward.
+    QList<Span> blocks;
+    QHash<QStringView, qsizetype> cursors;
+    qsizetype lastEnd = 0;
+    for (Span &span : opens) {
+        if (span.start < lastEnd)
+            continue;   // nested in the previous block
+        const auto it = closes.constFind(span.id);
+        if (it == closes.constEnd())
+            continue;
+        const QList<QPair<qsizetype, qsizetype>> &candidates = it.value();
+        qsizetype &cursor = cursors[span.id];
+        while (cursor < candidates.size() && candidates[cursor].first < span.contentStart)
+            ++cursor;
+        if (cursor == candidates.size())
+            continue;   // unclosed
+
+        setClose(text, candidates[cursor].first, candidates[cursor].second, span);
+        lastEnd = span.end;
+        blocks.append(span);
+    }
+    return blocks;
+}
+
+std::optional<Span> find(QStringView text, QStringView id)
+{
+    Span span;
+    qsizetype pos = text.indexOf(kCommentOpen);
+    while (pos >= 0 && !(parseOpen(text, pos, span) && span.id == id))
+        pos = text.indexOf(kCommentOpen, pos + 1);
+    if (pos < 0)
+        return std::nullopt;
+
+    for (pos = text.indexOf(kCommentOpen, span.contentStart); pos >= 0;
+         pos = text.indexOf(kCommentOpen, pos + 1)) {
+        QStringView closeId;
+        const qsizetype end = parseClose(text, pos, closeId);
+        if (end >= 0 && closeId == id) {
+            setClose(text, pos, end, span);
+            return span;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace BlockScanner
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QList>
+#include <QStringView>
+#include <optional>
+
+// Finds block markers in markdown text:
+//
+//   <!-- block: Name [id:1a2b3c] -->
+//   content
+//   <!-- /block:1a2b3c -->
+//
+// A hand-written forward scan instead of a backreferencing regex — every
+// marker is visited once, so cost stays linear in the text however many
+// blocks are left unclosed. Spaces and tabs inside markers are optional; the
+// opening marker must end its line.
+namespace BlockScanner {
+
+struct Span {
+    qsizetype start = 0;          // '<' of the opening marker
+    qsizetype contentStart = 0;   // after the opening marker's line break
+    qsizetype contentEnd = 0;     // before the line break preceding the closing marker
+    qsizetype closeStart = 0;     // '<' of the closing marker
+    qsizetype end = 0;            // one past the closing marker
+    QStringView id;               // views into the scanned text
+    QStringView name;
+};
+
+// Every top-level block in document order. A block nested inside another
+// is part of the outer block's content.
+QList<Span> scan(QStringView text);
+
+// First block with the given id, nested or not
+std::optional<Span> find(QStringView text, QStringView id);
+
+} // namespace BlockScanner
@@ -1,5 +1,6 @@
 #include "blockstore.h"
 #include "utils.h"
+#include "textsearch.h"
 
 #include <QFile>
 #include <QSaveFile>
@@ -7,14 +8,88 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr int kJournalFlushMs = 250;
+constexpr qint64 kMinCompactBytes = 1 << 20;   // journal size that always compacts
+
+QJsonObject blockToJson(const BlockData &b)
+{
+    QJsonObject obj;
+    obj["id"] = b.id;
+    obj["name"] = b.name;
+    obj["content"] = b.content;
+    if (b.syncedContent != b.content)
+        obj["syncedContent"] = b.syncedContent;
+    obj["sourceFile"] = b.sourceFile;
+    obj["createdAt"] = b.createdAt.toString(Qt::ISODate);
+    obj["updatedAt"] = b.updatedAt.toString(Qt::ISODate);
+    obj["tags"] = QJsonArray::fromStringList(b.tags);
+    return obj;
+}
+
+BlockData blockFromJson(const QJsonObject &obj)
+{
+    BlockData b;
+    b.id = obj["id"].toString();
+    b.name = obj["name"].toString();
+    b.content = obj["content"].toString();
+    b.contentHash = Utils::contentHash(b.content);
+    // Only stored while it differs from content
+    b.syncedContent = obj.contains("syncedContent") ? obj["syncedContent"].toString()
+                                                     : b.content;
+    b.sourceFile = obj["sourceFile"].toString();
+    b.createdAt = QDateTime::fromString(obj["createdAt"].toString(), Qt::ISODate);
+    b.updatedAt = QDateTime::fromString(obj["updatedAt"].toString(), Qt::ISODate);
+
+    for (const auto &t : obj["tags"].toArray())
+        b.tags.append(t.toString());
+    return b;
+}
+
+// Flush through to the disk, not just the OS cache
+bool syncToDisk(QFile &file)
+{
+    if (!file.flush())
+        return false;
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+} // namespace
 
 BlockStore::BlockStore(const QString &dbPath, QObject *parent)
     : QAbstractListModel(parent)
     , m_dbPath(dbPath)
+    , m_history(QFileInfo(dbPath).absolutePath() + "/block-history")
 {
+    const QFileInfo info(dbPath);
+    m_journalPath = info.absolutePath() + "/" + info.completeBaseName() + ".journal";
+
+    m_journalTimer.setSingleShot(true);
+    m_journalTimer.setInterval(kJournalFlushMs);
+    connect(&m_journalTimer, &QTimer::timeout, this, &BlockStore::flushJournal);
+
     load();
 }
 
+BlockStore::~BlockStore()
+{
+    flushJournal();
+}
+
 int BlockStore::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid())
@@ -68,6 +143,8 @@ QString BlockStore::createBlock(const QString &name, const QString &content,
     block.id = id;
     block.name = name;
     block.content = content;
+    block.contentHash = Utils::contentHash(content);
+    block.syncedContent = content;
     block.tags = tags;
     block.sourceFile = sourceFile;
     block.createdAt = QDateTime::currentDateTimeUtc();
@@ -75,7 +152,7 @@ QString BlockStore::createBlock(const QString &name, const QString &content,
 
     m_blocks.insert(id, block);
     rebuildFiltered();
-    save();
+    journal({{"op", "put"}, {"block", blockToJson(block)}});
     emit countChanged();
     emit allTagsChanged();
     return id;
@@ -86,7 +163,11 @@ void BlockStore::updateBlock(const QString &id, const QString &content)
     auto it = m_blocks.find(id);
     if (it == m_blocks.end()) return;
 
+    const bool changed = it->content != content;
+    const QString previous = it->content;
+    const QDateTime previousAt = it->updatedAt;
     it->content = content;
+    it->contentHash = Utils::contentHash(content);
     it->updatedAt = QDateTime::currentDateTimeUtc();
 
     // Notify the view
@@ -96,10 +177,81 @@ void BlockStore::updateBlock(const QString &id, const QString &content)
         emit dataChanged(idx, idx, {ContentRole, UpdatedAtRole});
     }
 
-    save();
+    journal({{"op", "set"}, {"id", id}, {"content", content},
+             {"updatedAt", it->updatedAt.toString(Qt::ISODate)}});
+    // History must not run ahead of the registry on disk, so the journal
+    // is written before the version
+    if (changed) {
+        flushJournal();
+        m_history.append(id, previous, previousAt, content);
+    }
     emit blockUpdated(id);
 }
 
+QStringList BlockStore::setSynced(const QHash<QString, QString> &contentById,
+                                  const QHash<QString, quint64> &expectedHash)
+{
+    QStringList stale;
+    struct PendingVersion {
+        QString id;
+        QString previous;
+        QDateTime savedAt;
+    };
+    QVector<PendingVersion> versions;
+    QStringList changed;
+    for (auto it = contentById.cbegin(); it != contentById.cend(); ++it) {
+        auto block = m_blocks.find(it.key());
+        if (block == m_blocks.end()) continue;
+        const auto expected = expectedHash.constFind(it.key());
+        if (expected != expectedHash.cend() && *expected != block->contentHash) {
+            stale.append(it.key());
+            continue;
+        }
+
+        block->syncedContent = it.value();
+        QJsonObject record{{"op", "set"}, {"id", it.key()}, {"syncedContent", it.value()}};
+        if (block->content == it.value()) {
+            journal(record);
+            continue;
+        }
+        versions.append({it.key(), block->content, block->updatedAt});
+        block->content = it.value();
+        block->contentHash = Utils::contentHash(it.value());
+        block->updatedAt = QDateTime::currentDateTimeUtc();
+        record["content"] = it.value();
+        record["updatedAt"] = block->updatedAt.toString(Qt::ISODate);
+        journal(record);
+        changed.append(it.key());
+
+        int row = m_filteredIds.indexOf(it.key());
+        if (row >= 0) {
+            QModelIndex idx = index(row);
+            emit dataChanged(idx, idx, {ContentRole, UpdatedAtRole});
+        }
+    }
+
+    // As in updateBlock, the registry reaches disk before its history
+    if (!versions.isEmpty()) {
+        flushJournal();
+        for (const PendingVersion &v : std::as_const(versions))
+            m_history.append(v.id, v.previous, v.savedAt, contentById.value(v.id));
+    }
+    for (const QString &id : changed)
+        emit blockUpdated(id);
+    return stale;
+}
+
+void BlockStore::setSyncedBase(const QHash<QString, QString> &contentById)
+{
+    for (auto it = contentById.cbegin(); it != contentById.cend(); ++it) {
+        auto block = m_blocks.find(it.key());
+        if (block == m_blocks.end() || block->syncedContent == it.value()) continue;
+
+        block->syncedContent = it.value();
+        journal({{"op", "set"}, {"id", it.key()}, {"syncedContent", it.value()}});
+    }
+}
+
 void BlockStore::renameBlock(const QString &id, const QString &newName)
 {
     auto it = m_blocks.find(id);
@@ -114,7 +266,8 @@ void BlockStore::renameBlock(const QString &id, const QString &newName)
         emit dataChanged(idx, idx, {NameRole, UpdatedAtRole});
     }
 
-    save();
+    journal({{"op", "set"}, {"id", id}, {"name", newName},
+             {"updatedAt", it->updatedAt.toString(Qt::ISODate)}});
 }
 
 void BlockStore::removeBlock(const QString &id)
@@ -122,8 +275,9 @@ void BlockStore::removeBlock(const QString &id)
     if (!m_blocks.contains(id)) return;
 
     m_blocks.remove(id);
+    m_history.remove(id);
     rebuildFiltered();
-    save();
+    journal({{"op", "remove"}, {"id", id}});
     emit countChanged();
     emit allTagsChanged();
 }
@@ -141,7 +295,7 @@ void BlockStore::addTag(const QString &id, const QString &tag)
         emit dataChanged(idx, idx, {TagsRole});
     }
 
-    save();
+    journal({{"op", "set"}, {"id", id}, {"tags", QJsonArray::fromStringList(it->tags)}});
     emit allTagsChanged();
 }
 
@@ -157,10 +311,38 @@ void BlockStore::removeTag(const QString &id, const QString &tag)
         emit dataChanged(idx, idx, {TagsRole});
     }
 
-    save();
+    journal({{"op", "set"}, {"id", id}, {"tags", QJsonArray::fromStringList(it->tags)}});
     emit allTagsChanged();
 }
 
+QVariantList BlockStore::blockVersions(const QString &id) const
+{
+    auto it = m_blocks.constFind(id);
+    if (it == m_blocks.constEnd()) return {};
+
+    QVariantList list;
+    for (const auto &v : m_history.versions(id)) {
+        QVariantMap m;
+        m["version"] = v.index;
+        m["savedAt"] = v.savedAt.toString(Qt::ISODate);
+        m["current"] = false;
+        list.append(m);
+    }
+    QVariantMap current;
+    current["version"] = list.size();
+    current["savedAt"] = it->updatedAt.toString(Qt::ISODate);
+    current["current"] = true;
+    list.append(current);
+    return list;
+}
+
+QString BlockStore::blockVersion(const QString &id, int version) const
+{
+    auto it = m_blocks.constFind(id);
+    if (it == m_blocks.constEnd()) return {};
+    return m_history.materialize(id, version, it->content).value_or(QString());
+}
+
 QVariantMap BlockStore::getBlock(const QString &id) const
 {
     auto it = m_blocks.find(id);
@@ -177,11 +359,11 @@ QVariantMap BlockStore::getBlock(const QString &id) const
     return m;
 }
 
-std::optional<BlockData> BlockStore::blockById(const QString &id) const
+const BlockData *BlockStore::findBlock(const QString &id) const
 {
-    auto it = m_blocks.find(id);
-    if (it == m_blocks.end()) return std::nullopt;
-    return *it;
+    auto it = m_blocks.constFind(id);
+    if (it == m_blocks.constEnd()) return nullptr;
+    return &it.value();
 }
 
 QString BlockStore::searchFilter() const { return m_searchFilter; }
@@ -218,69 +400,142 @@ QStringList BlockStore::allTags() const
 
 void BlockStore::load()
 {
+    m_blocks.clear();
+    m_snapshotBytes = 0;
+    m_journalBytes = 0;
+
     QFile file(m_dbPath);
-    if (!file.open(QIODevice::ReadOnly)) {
+    if (file.open(QIODevice::ReadOnly)) {
+        const QByteArray json = file.readAll();
+        file.close();
+        m_snapshotBytes = json.size();
+
+        QJsonParseError err;
+        QJsonDocument doc = QJsonDocument::fromJson(json, &err);
+        if (err.error != QJsonParseError::NoError || !doc.isObject()) {
+            qWarning("BlockStore: JSON parse error in %s: %s", qPrintable(m_dbPath), qPrintable(err.errorString()));
+            return;
+        }
+
+        QJsonObject blocksObj = doc.object()["blocks"].toObject();
+        for (auto it = blocksObj.begin(); it != blocksObj.end(); ++it) {
+            BlockData b = blockFromJson(it.value().toObject());
+            m_blocks.insert(b.id, b);
+        }
+    } else if (file.exists()) {
         qWarning("BlockStore: failed to open %s", qPrintable(m_dbPath));
         return;
     }
 
-    QJsonParseError err;
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &err);
-    file.close();
+    // Replay mutations journaled since the snapshot. A torn last record
+    // (crash mid-append) ends the replay.
+    bool torn = false;
+    QFile journalFile(m_journalPath);
+    if (journalFile.open(QIODevice::ReadOnly)) {
+        m_journalBytes = journalFile.size();
+        while (!journalFile.atEnd()) {
+            const QByteArray line = journalFile.readLine();
+            QJsonParseError err;
+            const QJsonDocument record = QJsonDocument::fromJson(line, &err);
+            if (!line.endsWith('\n') || err.error != QJsonParseError::NoError || !record.isObject()) {
+                torn = true;
+                break;
+            }
+            replay(record.object());
+        }
+        journalFile.close();
+    }
 
-    if (err.error != QJsonParseError::NoError || !doc.isObject()) {
-        qWarning("BlockStore: JSON parse error in %s: %s", qPrintable(m_dbPath), qPrintable(err.errorString()));
+    rebuildFiltered();
+    emit countChanged();
+    emit allTagsChanged();
+
+    // New records must not follow a torn one
+    if (torn) {
+        qWarning("BlockStore: ignored a damaged record at the end of %s", qPrintable(m_journalPath));
+        save();
+    }
+}
+
+void BlockStore::replay(const QJsonObject &record)
+{
+    const QString op = record["op"].toString();
+    if (op == "put") {
+        BlockData b = blockFromJson(record["block"].toObject());
+        m_blocks.insert(b.id, b);
+        return;
+    }
+    if (op == "remove") {
+        m_blocks.remove(record["id"].toString());
         return;
     }
+    if (op != "set") return;
 
-    QJsonObject root = doc.object();
-    QJsonObject blocksObj = root["blocks"].toObject();
+    auto it = m_blocks.find(record["id"].toString());
+    if (it == m_blocks.end()) return;
 
-    m_blocks.clear();
+    if (record.contains("name"))
+        it->name = record["name"].toString();
+    if (record.contains("content")) {
+        it->content = record["content"].toString();
+        it->contentHash = Utils::contentHash(it->content);
+    }
+    if (record.contains("syncedContent"))
+        it->syncedContent = record["syncedContent"].toString();
+    if (record.contains("tags")) {
+        it->tags.clear();
+        for (const auto &t : record["tags"].toArray())
+            it->tags.append(t.toString());
+    }
+    if (record.contains("updatedAt"))
+        it->updatedAt = QDateTime::fromString(record["updatedAt"].toString(), Qt::ISODate);
+}
 
-    for (auto it = blocksObj.begin(); it != blocksObj.end(); ++it) {
-        QJsonObject obj = it.value().toObject();
-        BlockData b;
-        b.id = obj["id"].toString();
-        b.name = obj["name"].toString();
-        b.content = obj["content"].toString();
-        b.sourceFile = obj["sourceFile"].toString();
-        b.createdAt = QDateTime::fromString(obj["createdAt"].toString(), Qt::ISODate);
-        b.updatedAt = QDateTime::fromString(obj["updatedAt"].toString(), Qt::ISODate);
+void BlockStore::journal(const QJsonObject &record)
+{
+    m_pendingJournal += QJsonDocument(record).toJson(QJsonDocument::Compact);
+    m_pendingJournal += '\n';
+    if (!m_journalTimer.isActive())
+        m_journalTimer.start();
+}
 
-        for (const auto &t : obj["tags"].toArray())
-            b.tags.append(t.toString());
+void BlockStore::flushJournal()
+{
+    m_journalTimer.stop();
+    if (m_pendingJournal.isEmpty()) return;
 
-        m_blocks.insert(b.id, b);
+    QDir dir(QFileInfo(m_dbPath).absolutePath());
+    if (!dir.exists()) dir.mkpath(".");
+
+    QFile file(m_journalPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)
+        || file.write(m_pendingJournal) != m_pendingJournal.size() || !syncToDisk(file)) {
+        // A partial append would leave a torn record; a full snapshot
+        // replaces the journal instead
+        qWarning("BlockStore: could not append to %s", qPrintable(m_journalPath));
+        file.close();
+        save();
+        return;
     }
+    m_journalBytes = file.size();
+    file.close();
+    m_pendingJournal.clear();
 
-    rebuildFiltered();
-    emit countChanged();
-    emit allTagsChanged();
+    // Compact once replaying would cost more than reading the snapshot
+    if (m_journalBytes > std::max(kMinCompactBytes, m_snapshotBytes))
+        save();
 }
 
 void BlockStore::save()
 {
+    m_journalTimer.stop();
+
     QDir dir(QFileInfo(m_dbPath).absolutePath());
     if (!dir.exists()) dir.mkpath(".");
 
     QJsonObject blocksObj;
-    for (const auto &b : m_blocks) {
-        QJsonObject obj;
-        obj["id"] = b.id;
-        obj["name"] = b.name;
-        obj["content"] = b.content;
-        obj["sourceFile"] = b.sourceFile;
-        obj["createdAt"] = b.createdAt.toString(Qt::ISODate);
-        obj["updatedAt"] = b.updatedAt.toString(Qt::ISODate);
-
-        QJsonArray tagsArr;
-        for (const auto &t : b.tags)
-            tagsArr.append(t);
-        obj["tags"] = tagsArr;
-
-        blocksObj[b.id] = obj;
-    }
+    for (const auto &b : m_blocks)
+        blocksObj[b.id] = blockToJson(b);
 
     QJsonObject root;
     root["blocks"] = blocksObj;
@@ -301,7 +556,15 @@ void BlockStore::save()
     if (file.write(json) != json.size() || !file.commit()) {
         qWarning("BlockStore: write/commit failed for %s", qPrintable(m_dbPath));
         emit saveFailed(tr("Could not save blocks database"));
+        return;
     }
+    m_snapshotBytes = json.size();
+
+    // The snapshot now holds everything journaled so far
+    m_pendingJournal.clear();
+    m_journalBytes = 0;
+    if (QFile::exists(m_journalPath) && !QFile::remove(m_journalPath))
+        qWarning("BlockStore: could not clear %s", qPrintable(m_journalPath));
 }
 
 void BlockStore::rebuildFiltered()
@@ -309,6 +572,7 @@ void BlockStore::rebuildFiltered()
     beginResetModel();
     m_filteredIds.clear();
 
+    const TextSearch::Matcher matcher(m_searchFilter);
     for (auto it = m_blocks.begin(); it != m_blocks.end(); ++it) {
         const auto &b = it.value();
 
@@ -318,9 +582,9 @@ void BlockStore::rebuildFiltered()
 
         // Search filter
         if (!m_searchFilter.isEmpty()) {
-            bool match = b.name.contains(m_searchFilter, Qt::CaseInsensitive)
-                      || b.content.contains(m_searchFilter, Qt::CaseInsensitive)
-                      || b.tags.join(' ').contains(m_searchFilter, Qt::CaseInsensitive);
+            bool match = matcher.matches(b.name)
+                      || matcher.matches(b.content)
+                      || matcher.matches(b.tags.join(' '));
             if (!match) continue;
         }
 
@@ -6,13 +6,19 @@
 #include <QDateTime>
 #include <QHash>
 #include <QVector>
+#include <QTimer>
 #include <QtQml/qqmlregistration.h>
-#include <optional>
+
+#include "blockhistory.h"
+
+class QJsonObject;
 
 struct BlockData {
     QString id;
     QString name;
     QString content;
+    quint64 contentHash = 0;     // Utils::contentHash(content), kept in step with it
+    QString syncedContent;       // content last agreed with files; the merge base
     QStringList tags;
     QString sourceFile;
     QDateTime createdAt;
@@ -43,6 +49,7 @@ public:
     Q_ENUM(Roles)
 
     explicit BlockStore(const QString &dbPath, QObject *parent = nullptr);
+    ~BlockStore() override;
 
     // QAbstractListModel interface
     int rowCount(const QModelIndex &parent = {}) const override;
@@ -55,6 +62,15 @@ public:
     Q_INVOKABLE QString createBlock(const QString &name, const QString &content,
                                      const QStringList &tags, const QString &sourceFile);
     Q_INVOKABLE void updateBlock(const QString &id, const QString &content);
+    // Record content the registry and files agree on after a pull or merge:
+    // sets both the content and the merge base, with one save. Blocks listed
+    // in `expectedHash` whose content no longer hashes to that value were
+    // edited meanwhile; they are left untouched and returned.
+    QStringList setSynced(const QHash<QString, QString> &contentById,
+                          const QHash<QString, quint64> &expectedHash = {});
+    // Record content a push wrote to files as the merge base only; the
+    // registry content may have been edited while the push ran
+    void setSyncedBase(const QHash<QString, QString> &contentById);
     Q_INVOKABLE void renameBlock(const QString &id, const QString &newName);
     Q_INVOKABLE void removeBlock(const QString &id);
     Q_INVOKABLE void addTag(const QString &id, const QString &tag);
@@ -62,7 +78,15 @@ public:
 
     // Lookup
     Q_INVOKABLE QVariantMap getBlock(const QString &id) const;
-    std::optional<BlockData> blockById(const QString &id) const;
+    // No copy; the pointer is valid until the store is next modified
+    const BlockData *findBlock(const QString &id) const;
+
+    // History: earlier contents are kept in a per-block log next to the
+    // database. Versions run oldest first; the last one is the current content.
+    // [{version, savedAt, current}]
+    Q_INVOKABLE QVariantList blockVersions(const QString &id) const;
+    // Content of one version, or an empty string if it cannot be read
+    Q_INVOKABLE QString blockVersion(const QString &id, int version) const;
 
     // Filtering
     QString searchFilter() const;
@@ -71,7 +95,11 @@ public:
     void setTagFilter(const QString &tag);
     QStringList allTags() const;
 
-    // Persistence
+    // Persistence. The database file holds a snapshot; each mutation since
+    // is appended to a journal next to it as one compact JSON line, written
+    // and synced to disk in batches. load() replays the journal over the
+    // snapshot. save() writes a fresh snapshot and empties the journal,
+    // which also happens once the journal outgrows the snapshot.
     void load();
     void save();
 
@@ -86,8 +114,17 @@ signals:
 private:
     void rebuildFiltered();
     QString generateId() const;
+    void journal(const QJsonObject &record);
+    void flushJournal();
+    void replay(const QJsonObject &record);
 
     QString m_dbPath;
+    QString m_journalPath;
+    QByteArray m_pendingJournal;               // records not yet on disk
+    QTimer m_journalTimer;                     // batches journal writes
+    qint64 m_journalBytes = 0;
+    qint64 m_snapshotBytes = 0;
+    BlockHistory m_history;
     QHash<QString, BlockData> m_blocks;       // all blocks by id
     QVector<QString> m_filteredIds;            // visible ids after filtering
     QString m_searchFilter;
@@ -322,6 +322,28 @@ void ConfigManager::setSearchIncludeDocx(bool enabled)
     }
 }
 
+int ConfigManager::searchMaxResults() const { return m_searchMaxResults; }
+
+void ConfigManager::setSearchMaxResults(int count)
+{
+    count = qBound(50, count, 100000);
+    if (m_searchMaxResults != count) {
+        m_searchMaxResults = count;
+        emit searchMaxResultsChanged();
+    }
+}
+
+int ConfigManager::searchMaxHitsPerFile() const { return m_searchMaxHitsPerFile; }
+
+void ConfigManager::setSearchMaxHitsPerFile(int count)
+{
+    count = qBound(1, count, 10000);
+    if (m_searchMaxHitsPerFile != count) {
+        m_searchMaxHitsPerFile = count;
+        emit searchMaxHitsPerFileChanged();
+    }
+}
+
 QString ConfigManager::themeMode() const { return m_themeMode; }
 
 void ConfigManager::setThemeMode(const QString &mode)
@@ -465,6 +487,10 @@ void ConfigManager::load()
         m_searchIncludePdf = root["searchIncludePdf"].toBool(false);
     if (root.contains("searchIncludeDocx"))
         m_searchIncludeDocx = root["searchIncludeDocx"].toBool(false);
+    if (root.contains("searchMaxResults"))
+        m_searchMaxResults = qBound(50, root["searchMaxResults"].toInt(2000), 100000);
+    if (root.contains("searchMaxHitsPerFile"))
+        m_searchMaxHitsPerFile = qBound(1, root["searchMaxHitsPerFile"].toInt(100), 10000);
 
     if (root.contains("themeMode"))
         m_themeMode = root["themeMode"].toString("dark");
@@ -534,6 +560,8 @@ void ConfigManager::save()
     root["searchIncludePlaintext"] = m_searchIncludePlaintext;
     root["searchIncludePdf"] = m_searchIncludePdf;
     root["searchIncludeDocx"] = m_searchIncludeDocx;
+    root["searchMaxResults"] = m_searchMaxResults;
+    root["searchMaxHitsPerFile"] = m_searchMaxHitsPerFile;
 
     root["themeMode"] = m_themeMode;
     root["editorFontFamily"] = m_editorFontFamily;
@@ -40,6 +40,8 @@ class ConfigManager : public QObject
     Q_PROPERTY(bool searchIncludePlaintext READ searchIncludePlaintext WRITE setSearchIncludePlaintext NOTIFY searchIncludePlaintextChanged)
     Q_PROPERTY(bool searchIncludePdf READ searchIncludePdf WRITE setSearchIncludePdf NOTIFY searchIncludePdfChanged)
     Q_PROPERTY(bool searchIncludeDocx READ searchIncludeDocx WRITE setSearchIncludeDocx NOTIFY searchIncludeDocxChanged)
+    Q_PROPERTY(int searchMaxResults READ searchMaxResults WRITE setSearchMaxResults NOTIFY searchMaxResultsChanged)
+    Q_PROPERTY(int searchMaxHitsPerFile READ searchMaxHitsPerFile WRITE setSearchMaxHitsPerFile NOTIFY searchMaxHitsPerFileChanged)
     Q_PROPERTY(QString themeMode READ themeMode WRITE setThemeMode NOTIFY themeModeChanged)
     Q_PROPERTY(QString editorFontFamily READ editorFontFamily WRITE setEditorFontFamily NOTIFY editorFontFamilyChanged)
     Q_PROPERTY(bool wordWrap READ wordWrap WRITE setWordWrap NOTIFY wordWrapChanged)
@@ -131,6 +133,11 @@ public:
     bool searchIncludeDocx() const;
     void setSearchIncludeDocx(bool enabled);
 
+    int searchMaxResults() const;
+    void setSearchMaxResults(int count);
+    int searchMaxHitsPerFile() const;
+    void setSearchMaxHitsPerFile(int count);
+
     QString themeMode() const;
     void setThemeMode(const QString &mode);
 
@@ -173,6 +180,8 @@ signals:
     void searchIncludePlaintextChanged();
     void searchIncludePdfChanged();
     void searchIncludeDocxChanged();
+    void searchMaxResultsChanged();
+    void searchMaxHitsPerFileChanged();
     void themeModeChanged();
     void editorFontFamilyChanged();
     void wordWrapChanged();
@@ -211,6 +220,8 @@ private:
     bool m_searchIncludePlaintext = true;
     bool m_searchIncludePdf = false;
     bool m_searchIncludeDocx = false;
+    int m_searchMaxResults = 2000;
+    int m_searchMaxHitsPerFile = 100;
     QString m_themeMode = QStringLiteral("dark");
     QString m_editorFontFamily = QStringLiteral("Consolas");
     bool m_wordWrap = true;
@@ -1,4 +1,5 @@
 #include "document.h"
+#include "blockscanner.h"
 #include "blockstore.h"
 #include "utils.h"
 
@@ -377,18 +378,15 @@ void Document::parseBlocks()
 {
     m_blocks.clear();
 
-    static const QRegularExpression blockRx(
-        R"(<!-- block:\s*(.+?)\s*\[id:([a-f0-9]{6})\]\s*-->\r?\n([\s\S]*?)<!-- \/block:\2 -->)");
-
-    auto it = blockRx.globalMatch(m_rawContent);
-    while (it.hasNext()) {
-        auto match = it.next();
+    const QList<BlockScanner::Span> spans = BlockScanner::scan(m_rawContent);
+    m_blocks.reserve(spans.size());
+    for (const BlockScanner::Span &span : spans) {
         BlockSegment seg;
-        seg.name = match.captured(1);
-        seg.id = match.captured(2);
-        seg.content = match.captured(3);
-        seg.startPos = static_cast<int>(match.capturedStart());
-        seg.endPos = static_cast<int>(match.capturedEnd());
+        seg.name = span.name.toString();
+        seg.id = span.id.toString();
+        seg.content = m_rawContent.mid(span.contentStart, span.closeStart - span.contentStart);
+        seg.startPos = static_cast<int>(span.start);
+        seg.endPos = static_cast<int>(span.end);
         m_blocks.append(seg);
     }
 }
@@ -428,54 +426,36 @@ QVariantList Document::computeBlockRanges() const
     if (m_rawContent.isEmpty())
         return ranges;
 
-    static const QRegularExpression openRx(
-        QStringLiteral(R"(<!--\s*block:\s*(.+?)\s*\[id:([a-f0-9]{6})\]\s*-->)"));
-
-    const QStringList lines = m_rawContent.split('\n');
-    QString curId, curName;
-    int curStartLine = 0;
-    QStringList contentLines;
-    bool inBlock = false;
-
-    for (int i = 0; i < lines.size(); i++) {
-        const QString &line = lines[i];
-
-        if (!inBlock) {
-            auto m = openRx.match(line);
-            if (m.hasMatch()) {
-                curName = m.captured(1);
-                curId = m.captured(2);
-                curStartLine = i + 1;  // 1-based
-                contentLines.clear();
-                inBlock = true;
-            }
-        } else {
-            QRegularExpression closeRx(QStringLiteral("<!--\\s*/block:") + curId + QStringLiteral("\\s*-->"));
-            if (closeRx.match(line).hasMatch()) {
-                // Join and strip \r remnants from CRLF split-by-\n
-                QString content = contentLines.join('\n');
-                content.remove(QLatin1Char('\r'));
-                QString status = QStringLiteral("local");
-                if (m_blockStore) {
-                    auto storeBlock = m_blockStore->blockById(curId);
-                    if (storeBlock) {
-                        status = (storeBlock->content == content)
-                                     ? QStringLiteral("synced")
-                                     : QStringLiteral("diverged");
-                    }
-                }
-                QVariantMap entry;
-                entry[QStringLiteral("startLine")] = curStartLine;
-                entry[QStringLiteral("endLine")] = i + 1;
-                entry[QStringLiteral("id")] = curId;
-                entry[QStringLiteral("name")] = curName;
-                entry[QStringLiteral("status")] = status;
-                ranges.append(entry);
-                inBlock = false;
-            } else {
-                contentLines.append(line);
+    // Line numbers (1-based) are counted incrementally between spans
+    const QStringView text(m_rawContent);
+    qsizetype countedTo = 0;
+    int line = 1;
+    auto lineAt = [&](qsizetype pos) {
+        line += static_cast<int>(text.sliced(countedTo, pos - countedTo).count(u'\n'));
+        countedTo = pos;
+        return line;
+    };
+
+    const QList<BlockScanner::Span> spans = BlockScanner::scan(text);
+    for (const BlockScanner::Span &span : spans) {
+        const QString id = span.id.toString();
+        QString status = QStringLiteral("local");
+        if (m_blockStore) {
+            if (const BlockData *storeBlock = m_blockStore->findBlock(id)) {
+                const quint64 hash = Utils::contentHash(
+                    text.sliced(span.contentStart, span.contentEnd - span.contentStart));
+                status = (storeBlock->contentHash == hash)
+                             ? QStringLiteral("synced")
+                             : QStringLiteral("diverged");
             }
         }
+        QVariantMap entry;
+        entry[QStringLiteral("startLine")] = lineAt(span.start);
+        entry[QStringLiteral("endLine")] = lineAt(span.closeStart);
+        entry[QStringLiteral("id")] = id;
+        entry[QStringLiteral("name")] = span.name.toString();
+        entry[QStringLiteral("status")] = status;
+        ranges.append(entry);
     }
     return ranges;
 }
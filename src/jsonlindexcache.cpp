@@ -0,0 +1,294 @@
+#include "jsonlindexcache.h"
+#include "jsonlstore.h"
+#include "mappedfile.h"
+#include "utils.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+#include <QtEndian>
+
+namespace {
+
+constexpr quint32 kMagic = 0x42534A58;        // "BSJX"
+constexpr quint32 kVersion = 5;
+constexpr qint64 kHeaderSize = 64;            // header fields are zero-padded to this
+constexpr qint64 kFingerprintBytes = 4096;
+constexpr auto kStreamVersion = QDataStream::Qt_6_0;
+
+void writeEntry(QDataStream &out, const JsonlEntry &entry)
+{
+    const quint8 flags = (entry.hasToolUse ? 1 : 0) | (entry.isError ? 2 : 0);
+    out << entry.offset << qint32(entry.length) << qint32(entry.lineNumber) << flags
+        << entry.role << entry.preview << entry.timestamp << entry.sessionId << entry.model
+        << entry.tools << entry.uuid << entry.parentUuid;
+}
+
+void readEntry(QDataStream &in, JsonlEntry &entry)
+{
+    qint32 length = 0;
+    qint32 lineNumber = 0;
+    quint8 flags = 0;
+    in >> entry.offset >> length >> lineNumber >> flags >> entry.role >> entry.preview
+       >> entry.timestamp >> entry.sessionId >> entry.model >> entry.tools
+       >> entry.uuid >> entry.parentUuid;
+    entry.length = length;
+    entry.lineNumber = lineNumber;
+    entry.hasToolUse = (flags & 1) != 0;
+    entry.isError = (flags & 2) != 0;
+}
+
+void writeSegment(QDataStream &out, const JsonlTextIndex::Segment &segment)
+{
+    out << qint32(segment.entryCount) << segment.keys << segment.starts << segment.postings
+        << segment.truncated;
+}
+
+void readSegment(QDataStream &in, JsonlTextIndex::Segment &segment)
+{
+    qint32 entryCount = 0;
+    in >> entryCount >> segment.keys >> segment.starts >> segment.postings >> segment.truncated;
+    segment.entryCount = entryCount;
+
+    // starts must bracket every key's postings
+    if (segment.starts.size() != segment.keys.size() + 1
+        || segment.starts.constLast() != quint32(segment.postings.size()))
+        in.setStatus(QDataStream::ReadCorruptData);
+}
+
+void writeUsage(QDataStream &out, const JsonlUsageRecord &record)
+{
+    out << record.messageId << record.sessionId << record.model << record.inputTokens
+        << record.outputTokens << record.cacheCreationTokens << record.cacheReadTokens
+        << record.tools;
+}
+
+void readUsage(QDataStream &in, JsonlUsageRecord &record)
+{
+    in >> record.messageId >> record.sessionId >> record.model >> record.inputTokens
+       >> record.outputTokens >> record.cacheCreationTokens >> record.cacheReadTokens
+       >> record.tools;
+}
+
+} // namespace
+
+JsonlIndexCache::JsonlIndexCache(const QString &cachePath)
+    : m_path(cachePath)
+{
+}
+
+QString JsonlIndexCache::cachePathFor(const QString &cacheDir, const QString &sourcePath)
+{
+    const QByteArray key = QCryptographicHash::hash(
+        Utils::normalizePath(sourcePath).toUtf8(), QCryptographicHash::Sha1).toHex();
+    return cacheDir + QLatin1Char('/') + QString::fromLatin1(key) + QStringLiteral(".idx");
+}
+
+bool JsonlIndexCache::readHeader()
+{
+    m_header = Header();
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < kHeaderSize)
+        return false;
+
+    QDataStream in(file.read(kHeaderSize));
+    in.setVersion(kStreamVersion);
+    Header h;
+    in >> h.magic >> h.version >> h.fileSize >> h.mtime >> h.endOffset
+       >> h.lineCount >> h.entryCount >> h.recordsEnd >> h.fingerprint;
+
+    if (in.status() != QDataStream::Ok || h.magic != kMagic || h.version != kVersion
+        || h.recordsEnd < kHeaderSize || h.recordsEnd > file.size())
+        return false;
+
+    m_header = h;
+    return true;
+}
+
+quint64 JsonlIndexCache::fingerprintOf(const MappedFile &source, qint64 endOffset)
+{
+    const qint64 begin = qMax<qint64>(0, endOffset - kFingerprintBytes);
+    if (endOffset <= begin)
+        return 0;
+    const QByteArray digest = QCryptographicHash::hash(
+        source.bytes(begin, endOffset - begin), QCryptographicHash::Sha1);
+    return qFromBigEndian<quint64>(digest.constData());
+}
+
+bool JsonlIndexCache::validate(const MappedFile &source, qint64 sourceMtime)
+{
+    if (!readHeader())
+        return false;
+
+    const qint64 size = source.size();
+    if (size < m_header.fileSize || m_header.endOffset > size) {
+        m_header = Header();
+        return false;
+    }
+
+    // Unchanged file, or one that only grew (append-only transcript)
+    const bool valid = (size == m_header.fileSize)
+        ? sourceMtime == m_header.mtime
+        : fingerprintOf(source, m_header.endOffset) == m_header.fingerprint;
+    if (!valid)
+        m_header = Header();
+    return valid;
+}
+
+bool JsonlIndexCache::readChunks(QVector<JsonlChunk> &chunks) const
+{
+    if (m_header.magic != kMagic)
+        return false;
+
+    MappedFile file;
+    if (!file.open(m_path) || file.size() < m_header.recordsEnd)
+        return false;
+
+    QDataStream in(file.bytes(kHeaderSize, m_header.recordsEnd - kHeaderSize));
+    in.setVersion(kStreamVersion);
+
+    // Share repeated strings the same way the worker does
+    QSet<QString> strings;
+
+    QVector<JsonlChunk> result;
+    qint32 remaining = m_header.entryCount;
+    while (remaining > 0) {
+        qint32 count = 0;
+        in >> count;
+        if (in.status() != QDataStream::Ok || count <= 0 || count > remaining)
+            return false;
+
+        JsonlChunk chunk;
+        chunk.entries.resize(count);
+        for (JsonlEntry &entry : chunk.entries) {
+            readEntry(in, entry);
+            entry.role = *strings.insert(entry.role);
+            entry.sessionId = *strings.insert(entry.sessionId);
+            entry.model = *strings.insert(entry.model);
+            for (QString &tool : entry.tools)
+                tool = *strings.insert(tool);
+        }
+        readSegment(in, chunk.textIndex);
+
+        qint32 callCount = 0;
+        in >> callCount;
+        if (in.status() != QDataStream::Ok || callCount < 0 || callCount > qint64(count) * 64)
+            return false;
+        chunk.toolCalls.resize(callCount);
+        for (JsonlToolCall &call : chunk.toolCalls) {
+            qint32 entry = 0;
+            in >> entry >> call.id >> call.name;
+            call.entry = entry;
+            if (entry < 0 || entry >= count)
+                in.setStatus(QDataStream::ReadCorruptData);
+        }
+
+        qint32 usageCount = 0;
+        in >> usageCount;
+        if (in.status() != QDataStream::Ok || usageCount < 0 || usageCount > count)
+            return false;
+        chunk.usage.resize(usageCount);
+        for (JsonlUsageRecord &record : chunk.usage) {
+            readUsage(in, record);
+            record.sessionId = *strings.insert(record.sessionId);
+            record.model = *strings.insert(record.model);
+        }
+        if (in.status() != QDataStream::Ok)
+            return false;
+
+        remaining -= count;
+        result.append(std::move(chunk));
+    }
+
+    chunks = std::move(result);
+    return true;
+}
+
+bool JsonlIndexCache::beginWrite(bool append)
+{
+    m_appending = append && m_header.magic == kMagic;
+    m_pendingCount = 0;
+
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    m_file.setFileName(m_path);
+
+    if (m_appending) {
+        // Records past recordsEnd belong to an interrupted write — overwrite them
+        if (!m_file.open(QIODevice::ReadWrite))
+            return false;
+        return m_file.seek(m_header.recordsEnd);
+    }
+
+    m_header = Header();
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    // Zeroed header marks the file invalid until commit() writes the real one
+    return m_file.write(QByteArray(kHeaderSize, '\0')) == kHeaderSize;
+}
+
+void JsonlIndexCache::appendChunk(const JsonlChunk &chunk)
+{
+    if (!m_file.isOpen() || chunk.entries.isEmpty())
+        return;
+
+    QDataStream out(&m_file);
+    out.setVersion(kStreamVersion);
+    out << qint32(chunk.entries.size());
+    for (const JsonlEntry &entry : chunk.entries)
+        writeEntry(out, entry);
+    writeSegment(out, chunk.textIndex);
+    out << qint32(chunk.toolCalls.size());
+    for (const JsonlToolCall &call : chunk.toolCalls)
+        out << qint32(call.entry) << call.id << call.name;
+    out << qint32(chunk.usage.size());
+    for (const JsonlUsageRecord &record : chunk.usage)
+        writeUsage(out, record);
+    m_pendingCount += chunk.entries.size();
+}
+
+bool JsonlIndexCache::commit(const MappedFile &source, qint64 sourceMtime,
+                             qint64 endOffset, int lineCount)
+{
+    if (!m_file.isOpen())
+        return false;
+
+    const qint64 recordsEnd = m_file.pos();
+    m_file.resize(recordsEnd);
+
+    m_header.magic = kMagic;
+    m_header.version = kVersion;
+    m_header.fileSize = source.size();
+    m_header.mtime = sourceMtime;
+    m_header.endOffset = endOffset;
+    m_header.lineCount = lineCount;
+    m_header.entryCount += m_pendingCount;
+    m_header.recordsEnd = recordsEnd;
+    m_header.fingerprint = fingerprintOf(source, endOffset);
+    m_pendingCount = 0;
+
+    QByteArray headerBytes;
+    QDataStream out(&headerBytes, QIODevice::WriteOnly);
+    out.setVersion(kStreamVersion);
+    out << m_header.magic << m_header.version << m_header.fileSize << m_header.mtime
+        << m_header.endOffset << m_header.lineCount << m_header.entryCount
+        << m_header.recordsEnd << m_header.fingerprint;
+    headerBytes.resize(kHeaderSize, '\0');
+
+    const bool ok = m_file.seek(0) && m_file.write(headerBytes) == kHeaderSize
+                    && m_file.flush();
+    m_file.close();
+    return ok;
+}
+
+void JsonlIndexCache::discard()
+{
+    if (!m_file.isOpen())
+        return;
+    m_file.close();
+    if (!m_appending)
+        QFile::remove(m_path);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+class MappedFile;
+struct JsonlChunk;
+
+// Binary sidecar index for one JSONL transcript, stored in the app config
+// folder and keyed by the transcript path. Holds everything the worker
+// produced per chunk (line summaries, text index segment, tool-call links,
+// usage records) plus the offset where parsing stopped, so a reopen can show
+// and filter the list without re-parsing and only parse what was appended.
+//
+// Layout: fixed header followed by one block per chunk. The header is
+// rewritten last on commit, so an interrupted write leaves the previous
+// state valid.
+class JsonlIndexCache
+{
+public:
+    explicit JsonlIndexCache(const QString &cachePath);
+
+    static QString cachePathFor(const QString &cacheDir, const QString &sourcePath);
+
+    // Read the header and check it still describes a prefix of `source`
+    // (same size+mtime, or grown with an unchanged fingerprint). The
+    // fingerprint only covers the 4 KiB before the resume offset, so this is
+    // a heuristic for append-only files: a rewrite that keeps those bytes
+    // and does not shrink the file goes unnoticed.
+    bool validate(const MappedFile &source, qint64 sourceMtime);
+
+    // Decode all cached chunks (memory-maps the cache file). Call after validate().
+    bool readChunks(QVector<JsonlChunk> &chunks) const;
+
+    qint64 resumeOffset() const { return m_header.endOffset; }
+    int lineCount() const { return m_header.lineCount; }
+
+    // Writing: start fresh or append after the validated state, add records,
+    // then commit the new resume point (or discard on cancel). The resume
+    // point must directly follow a newline.
+    bool beginWrite(bool append);
+    void appendChunk(const JsonlChunk &chunk);
+    bool commit(const MappedFile &source, qint64 sourceMtime, qint64 endOffset, int lineCount);
+    void discard();
+
+private:
+    struct Header {
+        quint32 magic = 0;
+        quint32 version = 0;
+        qint64 fileSize = 0;        // source size when committed
+        qint64 mtime = 0;           // source mtime (ms since epoch) when committed
+        qint64 endOffset = 0;       // resume offset into the source
+        qint32 lineCount = 0;       // source lines consumed up to endOffset
+        qint32 entryCount = 0;
+        qint64 recordsEnd = 0;      // end of valid records in the cache file
+        quint64 fingerprint = 0;    // hash of the source bytes just before endOffset
+    };
+
+    bool readHeader();
+    static quint64 fingerprintOf(const MappedFile &source, qint64 endOffset);
+
+    QString m_path;
+    Header m_header;
+    QFile m_file;
+    bool m_appending = false;
+    qint32 m_pendingCount = 0;
+};
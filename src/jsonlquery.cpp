@@ -0,0 +1,398 @@
+#include "jsonlquery.h"
+#include "jsonlstore.h"
+
+#include <QDateTime>
+#include <QTimeZone>
+#include <QVector>
+
+namespace {
+
+enum class Field {
+    Role,
+    Tool,
+    Model,
+    Session,
+    Uuid,
+    ParentUuid,
+    Line,
+    Timestamp,
+    IsError,
+    ToolUse
+};
+
+bool fieldFromName(const QString &name, Field &field)
+{
+    static const QHash<QString, Field> names = {
+        { QStringLiteral("role"),          Field::Role },
+        { QStringLiteral("tool"),          Field::Tool },
+        { QStringLiteral("tool_name"),     Field::Tool },
+        { QStringLiteral("tool_use.name"), Field::Tool },
+        { QStringLiteral("name"),          Field::Tool },
+        { QStringLiteral("model"),         Field::Model },
+        { QStringLiteral("sessionid"),     Field::Session },
+        { QStringLiteral("session"),       Field::Session },
+        { QStringLiteral("uuid"),          Field::Uuid },
+        { QStringLiteral("parentuuid"),    Field::ParentUuid },
+        { QStringLiteral("parent"),        Field::ParentUuid },
+        { QStringLiteral("line"),          Field::Line },
+        { QStringLiteral("timestamp"),     Field::Timestamp },
+        { QStringLiteral("time"),          Field::Timestamp },
+        { QStringLiteral("is_error"),      Field::IsError },
+        { QStringLiteral("error"),         Field::IsError },
+        { QStringLiteral("tool_use"),      Field::ToolUse },
+        { QStringLiteral("has_tool_use"),  Field::ToolUse },
+    };
+    const auto it = names.constFind(name.toLower());
+    if (it == names.constEnd())
+        return false;
+    field = it.value();
+    return true;
+}
+
+enum class Op { Eq, Ne, Contains, Lt, Le, Gt, Ge };
+
+struct Token {
+    enum Kind { Word, String, Operator, LParen, RParen, End } kind = End;
+    QString text;
+};
+
+bool isOperatorChar(QChar c)
+{
+    return c == u'=' || c == u'!' || c == u'<' || c == u'>' || c == u'~';
+}
+
+class Parser
+{
+public:
+    explicit Parser(const QString &text) : m_text(text) {}
+
+    JsonlQuery::Predicate parse()
+    {
+        if (!tokenize())
+            return {};
+        JsonlQuery::Predicate pred = parseOr();
+        if (pred && peek().kind != Token::End)
+            return fail(QStringLiteral("Unexpected '%1'").arg(peek().text));
+        return pred;
+    }
+
+    QString error() const { return m_error; }
+
+private:
+    bool tokenize()
+    {
+        qsizetype i = 0;
+        const qsizetype n = m_text.size();
+        while (i < n) {
+            const QChar c = m_text[i];
+            if (c.isSpace()) {
+                ++i;
+            } else if (c == u'(' || c == u')') {
+                m_tokens.append({c == u'(' ? Token::LParen : Token::RParen, QString(c)});
+                ++i;
+            } else if (c == u'"') {
+                QString value;
+                ++i;
+                while (i < n && m_text[i] != u'"') {
+                    if (m_text[i] == u'\\' && i + 1 < n)
+                        ++i;
+                    value.append(m_text[i++]);
+                }
+                if (i >= n) {
+                    m_error = QStringLiteral("Unterminated string");
+                    return false;
+                }
+                ++i;
+                m_tokens.append({Token::String, value});
+            } else if (isOperatorChar(c)) {
+                const qsizetype start = i;
+                while (i < n && isOperatorChar(m_text[i]))
+                    ++i;
+                m_tokens.append({Token::Operator, m_text.mid(start, i - start)});
+            } else {
+                const qsizetype start = i;
+                while (i < n && !m_text[i].isSpace() && !isOperatorChar(m_text[i])
+                       && m_text[i] != u'(' && m_text[i] != u')' && m_text[i] != u'"')
+                    ++i;
+                m_tokens.append({Token::Word, m_text.mid(start, i - start)});
+            }
+        }
+        return true;
+    }
+
+    const Token &peek() const
+    {
+        static const Token end;
+        return m_pos < m_tokens.size() ? m_tokens[m_pos] : end;
+    }
+
+    bool peekKeyword(const char *keyword) const
+    {
+        return peek().kind == Token::Word
+            && peek().text.compare(QLatin1String(keyword), Qt::CaseInsensitive) == 0;
+    }
+
+    JsonlQuery::Predicate fail(const QString &message)
+    {
+        if (m_error.isEmpty())
+            m_error = message;
+        return {};
+    }
+
+    JsonlQuery::Predicate parseOr()
+    {
+        JsonlQuery::Predicate left = parseAnd();
+        while (left && peekKeyword("or")) {
+            ++m_pos;
+            JsonlQuery::Predicate right = parseAnd();
+            if (!right)
+                return {};
+            left = [left, right](const JsonlEntry &e) { return left(e) || right(e); };
+        }
+        return left;
+    }
+
+    JsonlQuery::Predicate parseAnd()
+    {
+        JsonlQuery::Predicate left = parseUnary();
+        while (left) {
+            if (peekKeyword("and")) {
+                ++m_pos;
+            } else if (!(peek().kind == Token::LParen
+                         || (peek().kind == Token::Word && !peekKeyword("or")))) {
+                break;
+            }
+            JsonlQuery::Predicate right = parseUnary();
+            if (!right)
+                return {};
+            left = [left, right](const JsonlEntry &e) { return left(e) && right(e); };
+        }
+        return left;
+    }
+
+    JsonlQuery::Predicate parseUnary()
+    {
+        if (peekKeyword("not")) {
+            ++m_pos;
+            JsonlQuery::Predicate inner = parseUnary();
+            if (!inner)
+                return {};
+            return [inner](const JsonlEntry &e) { return !inner(e); };
+        }
+        if (peek().kind == Token::LParen) {
+            ++m_pos;
+            JsonlQuery::Predicate inner = parseOr();
+            if (!inner)
+                return {};
+            if (peek().kind != Token::RParen)
+                return fail(QStringLiteral("Missing ')'"));
+            ++m_pos;
+            return inner;
+        }
+        return parsePredicate();
+    }
+
+    bool takeValue(QString &value)
+    {
+        if (peek().kind != Token::Word && peek().kind != Token::String)
+            return false;
+        value = m_tokens[m_pos++].text;
+        return true;
+    }
+
+    JsonlQuery::Predicate parsePredicate()
+    {
+        if (peek().kind != Token::Word)
+            return fail(peek().kind == Token::End ? QStringLiteral("Incomplete query")
+                                                  : QStringLiteral("Unexpected '%1'").arg(peek().text));
+        const QString fieldName = m_tokens[m_pos++].text;
+        Field field = Field::Role;
+        if (!fieldFromName(fieldName, field))
+            return fail(QStringLiteral("Unknown field '%1'").arg(fieldName));
+
+        if (peekKeyword("between")) {
+            ++m_pos;
+            QString low, high;
+            if (!takeValue(low) || !peekKeyword("and"))
+                return fail(QStringLiteral("Expected 'between A and B'"));
+            ++m_pos;
+            if (!takeValue(high))
+                return fail(QStringLiteral("Expected 'between A and B'"));
+            JsonlQuery::Predicate lower = comparison(field, Op::Ge, low);
+            if (!lower)
+                return {};
+            JsonlQuery::Predicate upper = comparison(field, Op::Le, high);
+            if (!upper)
+                return {};
+            return [lower, upper](const JsonlEntry &e) { return lower(e) && upper(e); };
+        }
+
+        if (peek().kind == Token::Operator) {
+            const QString opText = m_tokens[m_pos++].text;
+            Op op;
+            if (opText == QStringLiteral("=") || opText == QStringLiteral("=="))      op = Op::Eq;
+            else if (opText == QStringLiteral("!="))                                   op = Op::Ne;
+            else if (opText == QStringLiteral("~"))                                    op = Op::Contains;
+            else if (opText == QStringLiteral("<"))                                    op = Op::Lt;
+            else if (opText == QStringLiteral("<="))                                   op = Op::Le;
+            else if (opText == QStringLiteral(">"))                                    op = Op::Gt;
+            else if (opText == QStringLiteral(">="))                                   op = Op::Ge;
+            else return fail(QStringLiteral("Unknown operator '%1'").arg(opText));
+
+            QString value;
+            if (!takeValue(value))
+                return fail(QStringLiteral("Missing value after '%1'").arg(opText));
+            return comparison(field, op, value);
+        }
+
+        // Bare boolean field
+        if (field == Field::IsError || field == Field::ToolUse)
+            return comparison(field, Op::Eq, QStringLiteral("true"));
+        return fail(QStringLiteral("'%1' needs a comparison").arg(fieldName));
+    }
+
+    template <typename T>
+    static bool compareOrdered(const T &a, Op op, const T &b)
+    {
+        switch (op) {
+        case Op::Eq: return a == b;
+        case Op::Ne: return a != b;
+        case Op::Lt: return a < b;
+        case Op::Le: return a <= b;
+        case Op::Gt: return a > b;
+        case Op::Ge: return a >= b;
+        case Op::Contains: break;
+        }
+        return false;
+    }
+
+    static bool compareString(const QString &a, Op op, const QString &b)
+    {
+        if (op == Op::Contains)
+            return a.contains(b, Qt::CaseInsensitive);
+        const bool equal = a.compare(b, Qt::CaseInsensitive) == 0;
+        return op == Op::Eq ? equal : !equal;
+    }
+
+    JsonlQuery::Predicate comparison(Field field, Op op, const QString &value)
+    {
+        const bool ordered = op != Op::Eq && op != Op::Ne && op != Op::Contains;
+
+        switch (field) {
+        case Field::Role:
+        case Field::Model:
+        case Field::Session: {
+            if (ordered)
+                return fail(QStringLiteral("Use =, != or ~ for text fields"));
+            const QString JsonlEntry::*member = field == Field::Role ? &JsonlEntry::role
+                                              : field == Field::Model ? &JsonlEntry::model
+                                                                      : &JsonlEntry::sessionId;
+            return [member, op, value](const JsonlEntry &e) {
+                return compareString(e.*member, op, value);
+            };
+        }
+
+        case Field::Tool: {
+            if (ordered)
+                return fail(QStringLiteral("Use =, != or ~ for tool names"));
+            return [op, value](const JsonlEntry &e) {
+                // != means no listed tool matches
+                const Op test = op == Op::Ne ? Op::Eq : op;
+                bool any = false;
+                for (const QString &tool : e.tools) {
+                    if (compareString(tool, test, value)) {
+                        any = true;
+                        break;
+                    }
+                }
+                return op == Op::Ne ? !any : any;
+            };
+        }
+
+        case Field::Uuid:
+        case Field::ParentUuid: {
+            const QUuid JsonlEntry::*member = field == Field::Uuid ? &JsonlEntry::uuid
+                                                                   : &JsonlEntry::parentUuid;
+            if (op == Op::Contains) {
+                return [member, value](const JsonlEntry &e) {
+                    return !(e.*member).isNull()
+                        && (e.*member).toString(QUuid::WithoutBraces).contains(value, Qt::CaseInsensitive);
+                };
+            }
+            if (ordered)
+                return fail(QStringLiteral("Use =, != or ~ for UUIDs"));
+            const QUuid uuid = QUuid::fromString(value);
+            if (uuid.isNull())
+                return fail(QStringLiteral("'%1' is not a UUID (use ~ for partial ids)").arg(value));
+            return [member, op, uuid](const JsonlEntry &e) {
+                return (e.*member == uuid) == (op == Op::Eq);
+            };
+        }
+
+        case Field::Line: {
+            bool ok = false;
+            const int line = value.toInt(&ok);
+            if (!ok || op == Op::Contains)
+                return fail(QStringLiteral("Line needs a number and a numeric operator"));
+            return [op, line](const JsonlEntry &e) { return compareOrdered(e.lineNumber, op, line); };
+        }
+
+        case Field::Timestamp: {
+            QDateTime dt = QDateTime::fromString(value, Qt::ISODateWithMs);
+            if (!dt.isValid())
+                dt = QDateTime::fromString(value, Qt::ISODate);
+            if (!dt.isValid() || op == Op::Contains)
+                return fail(QStringLiteral("Timestamp needs an ISO date/time like 2025-06-01T10:00"));
+            // Logs record UTC; a time without a zone means UTC too, not local time
+            if (dt.timeSpec() == Qt::LocalTime)
+                dt.setTimeZone(QTimeZone::UTC);
+            const qint64 ms = dt.toMSecsSinceEpoch();
+            // Lines without a timestamp never match a time condition
+            return [op, ms](const JsonlEntry &e) {
+                return e.timestamp != 0 && compareOrdered(e.timestamp, op, ms);
+            };
+        }
+
+        case Field::IsError:
+        case Field::ToolUse: {
+            bool expected;
+            if (value.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0 || value == QStringLiteral("1"))
+                expected = true;
+            else if (value.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0 || value == QStringLiteral("0"))
+                expected = false;
+            else
+                return fail(QStringLiteral("Expected true or false, got '%1'").arg(value));
+            if (op != Op::Eq && op != Op::Ne)
+                return fail(QStringLiteral("Use = or != for flags"));
+            if (op == Op::Ne)
+                expected = !expected;
+            const bool JsonlEntry::*member = field == Field::IsError ? &JsonlEntry::isError
+                                                                     : &JsonlEntry::hasToolUse;
+            return [member, expected](const JsonlEntry &e) { return e.*member == expected; };
+        }
+        }
+        return fail(QStringLiteral("Unsupported field"));
+    }
+
+    QString m_text;
+    QVector<Token> m_tokens;
+    qsizetype m_pos = 0;
+    QString m_error;
+};
+
+} // namespace
+
+JsonlQuery JsonlQuery::compile(const QString &text, QString *error)
+{
+    JsonlQuery query;
+    if (error)
+        error->clear();
+    if (text.trimmed().isEmpty())
+        return query;
+
+    Parser parser(text);
+    query.m_predicate = parser.parse();
+    if (!query.m_predicate && error)
+        *error = parser.error().isEmpty() ? QStringLiteral("Invalid query") : parser.error();
+    return query;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QString>
+#include <functional>
+
+struct JsonlEntry;
+
+// Small query language over the fields the JSONL worker extracts per line.
+//
+//   tool == Bash and is_error
+//   timestamp between 2025-06-01T10:00 and 2025-06-01T12:00
+//   sessionId = 3f2a... or (role = user and not tool_use)
+//
+// Fields: role, tool, model, sessionId, uuid, parentUuid, line, timestamp,
+// is_error, tool_use. Operators: = == != ~ (contains) < <= > >= and
+// `between A and B`, combined with and / or / not and parentheses (adjacent
+// terms are and-ed). String comparisons ignore case; values with spaces go in
+// double quotes. A bare boolean field tests for true. Timestamps without a
+// zone are UTC, like the ones in the logs.
+class JsonlQuery
+{
+public:
+    using Predicate = std::function<bool(const JsonlEntry &)>;
+
+    JsonlQuery() = default;
+
+    // Blank text compiles to an empty query that matches everything. On a
+    // syntax error the result is empty too and `error` describes the problem.
+    static JsonlQuery compile(const QString &text, QString *error = nullptr);
+
+    bool isEmpty() const { return !m_predicate; }
+    bool matches(const JsonlEntry &entry) const { return !m_predicate || m_predicate(entry); }
+
+private:
+    Predicate m_predicate;
+};
@@ -1,238 +1,480 @@
 #include "jsonlstore.h"
+#include "jsonlindexcache.h"
 
-#include <QFile>
-#include <QTextStream>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QGuiApplication>
 #include <QClipboard>
+#include <QDateTime>
 #include <QFileInfo>
+#include <QSet>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <cstring>
+#include <limits>
 
-// ── JsonlWorker ──────────────────────────────────────────────
+namespace {
 
-JsonlWorker::JsonlWorker(const QString &filePath, quint64 generation,
-                         const std::shared_ptr<std::atomic<bool>> &cancelFlag,
-                         QObject *parent)
-    : QObject(parent), m_filePath(filePath), m_generation(generation), m_cancelFlag(cancelFlag)
+constexpr int kJsonCacheBytes = 32 * 1024 * 1024;
+constexpr int kJsonInitialChars = 32 * 1024;   // first page of an expanded card
+constexpr qint64 kTailCheckBytes = 4096;       // compared to spot a rewritten file
+
+bool isJsonSpace(char c)
 {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
 }
 
-void JsonlWorker::process()
+// Up to kTailCheckBytes ending at `end`, read from disk rather than the map
+QByteArray readTail(const QString &path, qint64 end)
 {
-    QFile file(m_filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        emit error(QStringLiteral("Could not open file: ") + m_filePath, m_generation);
-        emit finished(m_generation);
+    QFile file(path);
+    const qint64 begin = qMax<qint64>(0, end - kTailCheckBytes);
+    if (end <= 0 || !file.open(QIODevice::ReadOnly) || !file.seek(begin))
+        return {};
+    return file.read(end - begin);
+}
+
+// Per-line output that belongs to the chunk rather than the entry
+struct LineExtras {
+    QString text;                                  // searchable text for the index
+    QVector<QPair<QString, QString>> toolCalls;    // (id, name); name empty for results
+    JsonlUsageRecord usage;
+    bool hasUsage = false;
+};
+
+// Build the compact summary (role, tool-use flag, preview, query columns) for
+// one JSONL line and collect its searchable text for the index. The parsed
+// document is discarded afterwards; only the summary is kept.
+void summarizeLine(const QByteArray &line, JsonlEntry &entry, LineExtras &extras)
+{
+    QJsonParseError parseErr;
+    QJsonDocument doc = QJsonDocument::fromJson(line, &parseErr);
+
+    if (parseErr.error != QJsonParseError::NoError || !doc.isObject()) {
+        // Store invalid lines with an error preview
+        entry.preview = QStringLiteral("[Parse error: ") + parseErr.errorString() + QStringLiteral("] ")
+                        + QString::fromUtf8(line.left(320)).left(80);
+        entry.role = QStringLiteral("error");
+        entry.isError = true;
         return;
     }
 
-    QTextStream in(&file);
-    QVector<JsonlEntry> chunk;
-    int lineNum = 0;
-    constexpr int kChunkSize = 100;
+    const QJsonObject obj = doc.object();
+    extras.text = JsonlTextIndex::searchableText(obj);
+    extras.hasUsage = JsonlUsageRecord::fromJson(obj, extras.usage);
 
-    while (!in.atEnd()) {
-        if (m_cancelFlag && m_cancelFlag->load()) {
-            emit finished(m_generation);
-            return;
+    // Claude Code JSONL: data is nested inside "message" object
+    QJsonObject msg = obj.value(QStringLiteral("message")).toObject();
+    QString topType = obj.value(QStringLiteral("type")).toString();
+
+    // Query columns
+    const QString timestamp = obj.value(QStringLiteral("timestamp")).toString();
+    if (!timestamp.isEmpty()) {
+        const QDateTime dt = QDateTime::fromString(timestamp, Qt::ISODateWithMs);
+        if (dt.isValid())
+            entry.timestamp = dt.toMSecsSinceEpoch();
+    }
+    entry.sessionId = obj.value(QStringLiteral("sessionId")).toString();
+    entry.model = msg.value(QStringLiteral("model")).toString();
+    entry.uuid = QUuid::fromString(obj.value(QStringLiteral("uuid")).toString());
+    entry.parentUuid = QUuid::fromString(obj.value(QStringLiteral("parentUuid")).toString());
+
+    // Extract content value (from message.content or top-level content)
+    QJsonValue contentVal = msg.isEmpty()
+        ? obj.value(QStringLiteral("content"))
+        : msg.value(QStringLiteral("content"));
+
+    // Detect content block types for role/tool classification
+    bool hasToolResult = false;
+    bool hasToolUseBlock = false;
+    if (contentVal.isArray()) {
+        for (const QJsonValue &v : contentVal.toArray()) {
+            if (!v.isObject()) continue;
+            const QJsonObject block = v.toObject();
+            QString blockType = block.value(QStringLiteral("type")).toString();
+            if (blockType == QStringLiteral("tool_result")) {
+                hasToolResult = true;
+                if (block.value(QStringLiteral("is_error")).toBool(false))
+                    entry.isError = true;
+                extras.toolCalls.append({block.value(QStringLiteral("tool_use_id")).toString(), QString()});
+            }
+            if (blockType == QStringLiteral("tool_use")
+                || blockType == QStringLiteral("server_tool_use")) {
+                hasToolUseBlock = true;
+                const QString name = block.value(QStringLiteral("name")).toString();
+                if (!name.isEmpty() && !entry.tools.contains(name))
+                    entry.tools.append(name);
+                extras.toolCalls.append({block.value(QStringLiteral("id")).toString(), name});
+            }
+        }
+    }
+
+    // Determine role
+    if (topType == QStringLiteral("progress")) {
+        entry.role = QStringLiteral("progress");
+    } else if (hasToolResult) {
+        entry.role = QStringLiteral("tool");
+    } else if (!msg.isEmpty()) {
+        entry.role = msg.value(QStringLiteral("role")).toString();
+    } else if (obj.contains(QStringLiteral("role"))) {
+        entry.role = obj.value(QStringLiteral("role")).toString();
+    } else {
+        entry.role = topType;
+    }
+
+    // Detect tool use
+    entry.hasToolUse = hasToolUseBlock || hasToolResult
+                    || obj.contains(QStringLiteral("tool_use"))
+                    || obj.contains(QStringLiteral("tool_calls"));
+
+    // Build preview from content — handles all Claude API block types
+    if (contentVal.isString()) {
+        entry.preview = contentVal.toString().left(300).simplified();
+    } else if (contentVal.isArray()) {
+        QStringList parts;
+        for (const QJsonValue &v : contentVal.toArray()) {
+            if (!v.isObject()) continue;
+            QJsonObject block = v.toObject();
+            QString blockType = block.value(QStringLiteral("type")).toString();
+
+            if (blockType == QStringLiteral("text")) {
+                QString text = block.value(QStringLiteral("text")).toString();
+                if (!text.isEmpty())
+                    parts.append(text.left(200));
+
+            } else if (blockType == QStringLiteral("tool_use")) {
+                QString name = block.value(QStringLiteral("name")).toString();
+                QJsonObject input = block.value(QStringLiteral("input")).toObject();
+                QString argPreview;
+                for (auto it = input.begin(); it != input.end(); ++it) {
+                    if (it.value().isString()) {
+                        argPreview = it.value().toString().left(100).simplified();
+                        break;
+                    }
+                }
+                parts.append(QStringLiteral("\xF0\x9F\x94\xA7 ") + name
+                             + (argPreview.isEmpty() ? QString() : QStringLiteral(" ") + argPreview));
+
+            } else if (blockType == QStringLiteral("tool_result")) {
+                bool isError = block.value(QStringLiteral("is_error")).toBool(false);
+                QJsonValue resultContent = block.value(QStringLiteral("content"));
+                QString preview;
+                if (resultContent.isString()) {
+                    preview = resultContent.toString().left(200).simplified();
+                } else if (resultContent.isArray()) {
+                    // tool_result content can be array of content blocks
+                    for (const QJsonValue &rc : resultContent.toArray()) {
+                        if (rc.isObject() && rc.toObject().value(QStringLiteral("type")).toString() == QStringLiteral("text")) {
+                            preview = rc.toObject().value(QStringLiteral("text")).toString().left(200).simplified();
+                            break;
+                        }
+                    }
+                }
+                if (!preview.isEmpty())
+                    parts.append((isError ? QStringLiteral("\xE2\x9D\x8C ") : QStringLiteral("\xE2\x86\x90 ")) + preview);
+
+            } else if (blockType == QStringLiteral("thinking")) {
+                QString thinking = block.value(QStringLiteral("thinking")).toString();
+                if (!thinking.isEmpty())
+                    parts.append(QStringLiteral("\xF0\x9F\x92\xAD ") + thinking.left(150).simplified());
+
+            } else if (blockType == QStringLiteral("redacted_thinking")) {
+                parts.append(QStringLiteral("\xF0\x9F\x94\x92 [redacted thinking]"));
+
+            } else if (blockType == QStringLiteral("image")) {
+                QString mediaType = block.value(QStringLiteral("source")).toObject()
+                                    .value(QStringLiteral("media_type")).toString();
+                parts.append(QStringLiteral("\xF0\x9F\x96\xBC image") +
+                             (mediaType.isEmpty() ? QString() : QStringLiteral(" (") + mediaType + QStringLiteral(")")));
+
+            } else if (blockType == QStringLiteral("document")) {
+                QString title = block.value(QStringLiteral("title")).toString();
+                parts.append(QStringLiteral("\xF0\x9F\x93\x84 ") +
+                             (title.isEmpty() ? QStringLiteral("document") : title));
+
+            } else if (blockType == QStringLiteral("server_tool_use")) {
+                QString name = block.value(QStringLiteral("name")).toString();
+                parts.append(QStringLiteral("\xE2\x9A\x99 server:") + name);
+
+            } else if (blockType == QStringLiteral("web_search_tool_result")) {
+                QString query = block.value(QStringLiteral("search_query")).toString();
+                parts.append(QStringLiteral("\xF0\x9F\x94\x8D ") +
+                             (query.isEmpty() ? QStringLiteral("web search") : query.left(100)));
+            }
         }
+        entry.preview = parts.join(QStringLiteral(" | ")).left(400).simplified();
+    }
 
-        QString line = in.readLine().trimmed();
-        lineNum++;
+    // Progress entries: show hook/data info
+    if (topType == QStringLiteral("progress") && entry.preview.isEmpty()) {
+        QJsonObject data = obj.value(QStringLiteral("data")).toObject();
+        QString progType = data.value(QStringLiteral("type")).toString();
+        QString hookName = data.value(QStringLiteral("hookName")).toString();
+        if (!hookName.isEmpty())
+            entry.preview = progType + QStringLiteral(": ") + hookName;
+        else if (!progType.isEmpty())
+            entry.preview = progType;
+    }
 
-        if (line.isEmpty())
+    if (entry.preview.isEmpty()) {
+        // Fall back to first string value
+        for (auto it = obj.begin(); it != obj.end(); ++it) {
+            if (it.value().isString() && it.key() != QStringLiteral("role")
+                && it.key() != QStringLiteral("type")
+                && it.key() != QStringLiteral("uuid")
+                && it.key() != QStringLiteral("parentUuid")
+                && it.key() != QStringLiteral("sessionId")) {
+                entry.preview = it.value().toString().left(200).simplified();
+                break;
+            }
+        }
+    }
+
+    if (entry.preview.isEmpty())
+        entry.preview = QString::fromUtf8(line.left(480)).left(120);
+}
+
+constexpr qint64 kMinRangeBytes = 256 * 1024;
+constexpr qint64 kMaxRangeBytes = 8 * 1024 * 1024;
+
+struct ByteRange {
+    qint64 begin;
+    qint64 end;
+};
+
+struct ParsedRange {
+    JsonlChunk chunk;              // line numbers relative to the range start
+    int lineCount = 0;
+};
+
+// Parse every line in [range.begin, range.end). Runs on a pool thread.
+template <typename CancelFn>
+ParsedRange parseRange(const char *data, const ByteRange &range, const CancelFn &isCancelled)
+{
+    ParsedRange result;
+    JsonlTextIndex::SegmentBuilder textIndex;
+    LineExtras extras;
+    qint64 pos = range.begin;
+
+    while (pos < range.end) {
+        if ((result.lineCount & 0xFF) == 0 && isCancelled())
+            break;
+
+        const char *nl = static_cast<const char *>(
+            std::memchr(data + pos, '\n', size_t(range.end - pos)));
+        const qint64 lineEnd = nl ? qint64(nl - data) : range.end;
+        qint64 start = pos;
+        qint64 end = lineEnd;
+        pos = lineEnd + 1;
+        result.lineCount++;
+
+        while (start < end && isJsonSpace(data[start]))
+            start++;
+        while (end > start && isJsonSpace(data[end - 1]))
+            end--;
+        if (start == end)
             continue;
 
         JsonlEntry entry;
-        entry.lineNumber = lineNum;
+        entry.offset = start;
+        entry.length = int(end - start);
+        entry.lineNumber = result.lineCount;
+        extras.text.clear();
+        extras.toolCalls.clear();
+        extras.usage = JsonlUsageRecord();
+        extras.hasUsage = false;
+        summarizeLine(QByteArray::fromRawData(data + start, end - start), entry, extras);
+
+        // The preview is indexed too, so the filter never loses what it used to find
+        const int local = int(result.chunk.entries.size());
+        textIndex.addEntry(local, entry.preview + QLatin1Char('\n') + extras.text);
+        for (const auto &call : std::as_const(extras.toolCalls)) {
+            if (!call.first.isEmpty())
+                result.chunk.toolCalls.append({local, call.first, call.second});
+        }
+        if (extras.hasUsage)
+            result.chunk.usage.append(extras.usage);
+        result.chunk.entries.append(entry);
+    }
+    result.chunk.textIndex = textIndex.finish();
+    return result;
+}
 
-        QJsonParseError parseErr;
-        QJsonDocument doc = QJsonDocument::fromJson(line.toUtf8(), &parseErr);
+} // namespace
 
-        if (parseErr.error != QJsonParseError::NoError || !doc.isObject()) {
-            // Store invalid lines with an error preview
-            entry.preview = QStringLiteral("[Parse error: ") + parseErr.errorString() + QStringLiteral("] ") + line.left(80);
-            entry.role = QStringLiteral("error");
-        } else {
-            entry.data = doc.object();
-
-            // Claude Code JSONL: data is nested inside "message" object
-            QJsonObject msg = entry.data.value(QStringLiteral("message")).toObject();
-            QString topType = entry.data.value(QStringLiteral("type")).toString();
-
-            // Extract content value (from message.content or top-level content)
-            QJsonValue contentVal = msg.isEmpty()
-                ? entry.data.value(QStringLiteral("content"))
-                : msg.value(QStringLiteral("content"));
-
-            // Detect content block types for role/tool classification
-            bool hasToolResult = false;
-            bool hasToolUseBlock = false;
-            if (contentVal.isArray()) {
-                for (const QJsonValue &v : contentVal.toArray()) {
-                    if (!v.isObject()) continue;
-                    QString blockType = v.toObject().value(QStringLiteral("type")).toString();
-                    if (blockType == QStringLiteral("tool_result"))
-                        hasToolResult = true;
-                    if (blockType == QStringLiteral("tool_use")
-                        || blockType == QStringLiteral("server_tool_use"))
-                        hasToolUseBlock = true;
-                }
-            }
+// ── JsonlWorker ──────────────────────────────────────────────
 
-            // Determine role
-            if (topType == QStringLiteral("progress")) {
-                entry.role = QStringLiteral("progress");
-            } else if (hasToolResult) {
-                entry.role = QStringLiteral("tool");
-            } else if (!msg.isEmpty()) {
-                entry.role = msg.value(QStringLiteral("role")).toString();
-            } else if (entry.data.contains(QStringLiteral("role"))) {
-                entry.role = entry.data.value(QStringLiteral("role")).toString();
-            } else {
-                entry.role = topType;
-            }
+JsonlWorker::JsonlWorker(const QString &filePath, qint64 startOffset, int startLine,
+                         bool holdPartialLine, const QString &cachePath, quint64 generation,
+                         const std::shared_ptr<std::atomic<bool>> &cancelFlag,
+                         QObject *parent)
+    : QObject(parent), m_filePath(filePath), m_startOffset(startOffset), m_startLine(startLine)
+    , m_holdPartialLine(holdPartialLine), m_cachePath(cachePath), m_generation(generation), m_cancelFlag(cancelFlag)
+{
+}
 
-            // Detect tool use
-            entry.hasToolUse = hasToolUseBlock || hasToolResult
-                            || entry.data.contains(QStringLiteral("tool_use"))
-                            || entry.data.contains(QStringLiteral("tool_calls"));
-
-            // Build preview from content — handles all Claude API block types
-            if (contentVal.isString()) {
-                entry.preview = contentVal.toString().left(300).simplified();
-            } else if (contentVal.isArray()) {
-                QStringList parts;
-                for (const QJsonValue &v : contentVal.toArray()) {
-                    if (!v.isObject()) continue;
-                    QJsonObject block = v.toObject();
-                    QString blockType = block.value(QStringLiteral("type")).toString();
-
-                    if (blockType == QStringLiteral("text")) {
-                        QString text = block.value(QStringLiteral("text")).toString();
-                        if (!text.isEmpty())
-                            parts.append(text.left(200));
-
-                    } else if (blockType == QStringLiteral("tool_use")) {
-                        QString name = block.value(QStringLiteral("name")).toString();
-                        QJsonObject input = block.value(QStringLiteral("input")).toObject();
-                        QString argPreview;
-                        for (auto it = input.begin(); it != input.end(); ++it) {
-                            if (it.value().isString()) {
-                                argPreview = it.value().toString().left(100).simplified();
-                                break;
-                            }
-                        }
-                        parts.append(QStringLiteral("\xF0\x9F\x94\xA7 ") + name
-                                     + (argPreview.isEmpty() ? QString() : QStringLiteral(" ") + argPreview));
-
-                    } else if (blockType == QStringLiteral("tool_result")) {
-                        bool isError = block.value(QStringLiteral("is_error")).toBool(false);
-                        QJsonValue resultContent = block.value(QStringLiteral("content"));
-                        QString preview;
-                        if (resultContent.isString()) {
-                            preview = resultContent.toString().left(200).simplified();
-                        } else if (resultContent.isArray()) {
-                            // tool_result content can be array of content blocks
-                            for (const QJsonValue &rc : resultContent.toArray()) {
-                                if (rc.isObject() && rc.toObject().value(QStringLiteral("type")).toString() == QStringLiteral("text")) {
-                                    preview = rc.toObject().value(QStringLiteral("text")).toString().left(200).simplified();
-                                    break;
-                                }
-                            }
-                        }
-                        if (!preview.isEmpty())
-                            parts.append((isError ? QStringLiteral("\xE2\x9D\x8C ") : QStringLiteral("\xE2\x86\x90 ")) + preview);
-
-                    } else if (blockType == QStringLiteral("thinking")) {
-                        QString thinking = block.value(QStringLiteral("thinking")).toString();
-                        if (!thinking.isEmpty())
-                            parts.append(QStringLiteral("\xF0\x9F\x92\xAD ") + thinking.left(150).simplified());
-
-                    } else if (blockType == QStringLiteral("redacted_thinking")) {
-                        parts.append(QStringLiteral("\xF0\x9F\x94\x92 [redacted thinking]"));
-
-                    } else if (blockType == QStringLiteral("image")) {
-                        QString mediaType = block.value(QStringLiteral("source")).toObject()
-                                            .value(QStringLiteral("media_type")).toString();
-                        parts.append(QStringLiteral("\xF0\x9F\x96\xBC image") +
-                                     (mediaType.isEmpty() ? QString() : QStringLiteral(" (") + mediaType + QStringLiteral(")")));
-
-                    } else if (blockType == QStringLiteral("document")) {
-                        QString title = block.value(QStringLiteral("title")).toString();
-                        parts.append(QStringLiteral("\xF0\x9F\x93\x84 ") +
-                                     (title.isEmpty() ? QStringLiteral("document") : title));
-
-                    } else if (blockType == QStringLiteral("server_tool_use")) {
-                        QString name = block.value(QStringLiteral("name")).toString();
-                        parts.append(QStringLiteral("\xE2\x9A\x99 server:") + name);
-
-                    } else if (blockType == QStringLiteral("web_search_tool_result")) {
-                        QString query = block.value(QStringLiteral("search_query")).toString();
-                        parts.append(QStringLiteral("\xF0\x9F\x94\x8D ") +
-                                     (query.isEmpty() ? QStringLiteral("web search") : query.left(100)));
+void JsonlWorker::process()
+{
+    const qint64 mtime = QFileInfo(m_filePath).lastModified().toMSecsSinceEpoch();
+    MappedFile file;
+    if (!file.open(m_filePath)) {
+        emit error(QStringLiteral("Could not open file: ") + m_filePath, m_generation);
+        emit finished(m_generation, m_startOffset, m_startLine);
+        return;
+    }
+
+    const char *data = file.data();
+    qint64 size = file.size();
+    qint64 pos = qMin(m_startOffset, size);
+    int lineBase = m_startLine;
+
+    const auto cancel = m_cancelFlag;
+    auto isCancelled = [&cancel]() { return cancel && cancel->load(); };
+
+    // Sidecar index: replay it on a full run, extend it on an incremental one
+    std::unique_ptr<JsonlIndexCache> cache;
+    if (!m_cachePath.isEmpty()) {
+        cache = std::make_unique<JsonlIndexCache>(m_cachePath);
+        const bool valid = cache->validate(file, mtime);
+
+        if (pos == 0 && valid) {
+            QVector<JsonlChunk> cached;
+            if (cache->readChunks(cached)) {
+                for (const JsonlChunk &chunk : std::as_const(cached)) {
+                    if (isCancelled()) {
+                        emit finished(m_generation, m_startOffset, m_startLine);
+                        return;
                     }
+                    emit chunkReady(chunk, m_generation);
                 }
-                entry.preview = parts.join(QStringLiteral(" | ")).left(400).simplified();
+                pos = cache->resumeOffset();
+                lineBase = cache->lineCount();
+                emit progressChanged(lineBase, m_generation);
             }
+        }
 
-            // Progress entries: show hook/data info
-            if (topType == QStringLiteral("progress") && entry.preview.isEmpty()) {
-                QJsonObject data = entry.data.value(QStringLiteral("data")).toObject();
-                QString progType = data.value(QStringLiteral("type")).toString();
-                QString hookName = data.value(QStringLiteral("hookName")).toString();
-                if (!hookName.isEmpty())
-                    entry.preview = progType + QStringLiteral(": ") + hookName;
-                else if (!progType.isEmpty())
-                    entry.preview = progType;
-            }
+        // Only extend a cache that ends exactly where this run starts; a
+        // fresh cache must cover the file from its first byte
+        const bool append = valid && cache->resumeOffset() == pos;
+        if ((!append && pos != 0) || !cache->beginWrite(append))
+            cache.reset();
+    }
 
-            if (entry.preview.isEmpty()) {
-                // Fall back to first string value
-                for (auto it = entry.data.begin(); it != entry.data.end(); ++it) {
-                    if (it.value().isString() && it.key() != QStringLiteral("role")
-                        && it.key() != QStringLiteral("type")
-                        && it.key() != QStringLiteral("uuid")
-                        && it.key() != QStringLiteral("parentUuid")
-                        && it.key() != QStringLiteral("sessionId")) {
-                        entry.preview = it.value().toString().left(200).simplified();
-                        break;
-                    }
-                }
-            }
+    // Skip a UTF-8 BOM on the first line
+    if (pos == 0 && size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+        pos = 3;
+
+    // While following, bytes after the last newline are a write still in
+    // progress: even JSON that already parses may get its newline later, and
+    // resuming after it would count that newline as an extra line
+    if (m_holdPartialLine) {
+        while (size > pos && data[size - 1] != '\n')
+            size--;
+    }
+
+    // The sidecar cache stops after the last newline: a final line without
+    // one may still be growing, and a resume offset inside it would split it
+    qint64 cacheEnd = size;
+    while (cacheEnd > pos && data[cacheEnd - 1] != '\n')
+        cacheEnd--;
+
+    // Split the file into byte ranges that end on a newline. Ranges are parsed
+    // concurrently in batches of one range per pool thread, then merged in order.
+    // A trailing line without newline gets a range of its own.
+    const int threads = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    const qint64 rangeBytes = qBound<qint64>(kMinRangeBytes, (size - pos) / (threads * 4),
+                                             kMaxRangeBytes);
+
+    qint64 endOffset = pos;
+    qint64 cachedOffset = pos;
+    int cachedLines = lineBase;
+    QVector<ByteRange> ranges;
+    while (pos < cacheEnd) {
+        qint64 end = qMin(cacheEnd, pos + rangeBytes);
+        if (end < cacheEnd) {
+            const char *nl = static_cast<const char *>(
+                std::memchr(data + end, '\n', size_t(cacheEnd - end)));
+            end = nl ? qint64(nl - data) + 1 : cacheEnd;
+        }
+        ranges.append({pos, end});
+        pos = end;
+    }
+    if (pos < size)
+        ranges.append({pos, size});
+
+    // Roles, session ids, models and tool names repeat on every line — share
+    // one copy per distinct value
+    QSet<QString> strings;
+
+    for (int first = 0; first < ranges.size(); first += threads) {
+        if (isCancelled()) {
+            if (cache)
+                cache->discard();
+            emit finished(m_generation, endOffset, lineBase);
+            return;
+        }
 
-            if (entry.preview.isEmpty())
-                entry.preview = line.left(120);
+        const QVector<ByteRange> batch = ranges.mid(first, threads);
+        QVector<ParsedRange> parsed = QtConcurrent::blockingMapped<QVector<ParsedRange>>(
+            batch, [data, &isCancelled](const ByteRange &range) {
+                return parseRange(data, range, isCancelled);
+            });
+
+        if (isCancelled()) {
+            if (cache)
+                cache->discard();
+            emit finished(m_generation, endOffset, lineBase);
+            return;
         }
 
-        chunk.append(entry);
+        for (int i = 0; i < parsed.size(); ++i) {
+            ParsedRange &result = parsed[i];
+            for (JsonlEntry &entry : result.chunk.entries) {
+                entry.lineNumber += lineBase;
+                entry.role = *strings.insert(entry.role);
+                entry.sessionId = *strings.insert(entry.sessionId);
+                entry.model = *strings.insert(entry.model);
+                for (QString &tool : entry.tools)
+                    tool = *strings.insert(tool);
+            }
+            for (JsonlUsageRecord &record : result.chunk.usage) {
+                record.sessionId = *strings.insert(record.sessionId);
+                record.model = *strings.insert(record.model);
+            }
+            lineBase += result.lineCount;
+            endOffset = batch[i].end;
 
-        if (chunk.size() >= kChunkSize) {
-            if (m_cancelFlag && m_cancelFlag->load()) {
-                emit finished(m_generation);
-                return;
+            if (cache && endOffset <= cacheEnd) {
+                cache->appendChunk(result.chunk);
+                cachedOffset = endOffset;
+                cachedLines = lineBase;
             }
-            emit chunkReady(chunk, m_generation);
-            emit progressChanged(lineNum, m_generation);
-            chunk.clear();
+            if (!result.chunk.entries.isEmpty())
+                emit chunkReady(result.chunk, m_generation);
+            emit progressChanged(lineBase, m_generation);
         }
     }
 
-    // Emit remaining
-    if (!chunk.isEmpty()) {
-        emit chunkReady(chunk, m_generation);
-    }
+    if (cache)
+        cache->commit(file, mtime, cachedOffset, cachedLines);
 
-    file.close();
-    emit finished(m_generation);
+    emit finished(m_generation, endOffset, lineBase);
 }
 
 // ── JsonlStore ───────────────────────────────────────────────
 
-JsonlStore::JsonlStore(QObject *parent)
+JsonlStore::JsonlStore(const QString &cacheDir, QObject *parent)
     : QAbstractListModel(parent)
+    , m_cacheDir(cacheDir)
+    , m_jsonCache(kJsonCacheBytes)
+    , m_usage(new JsonlUsageModel(this))
 {
-    qRegisterMetaType<QVector<JsonlEntry>>("QVector<JsonlEntry>");
+    qRegisterMetaType<JsonlChunk>("JsonlChunk");
+
+    m_appendTimer.setSingleShot(true);
+    m_appendTimer.setInterval(250);
+    connect(&m_appendTimer, &QTimer::timeout, this, &JsonlStore::checkForAppend);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &JsonlStore::onFileChanged);
 }
 
 JsonlStore::~JsonlStore()
@@ -258,9 +500,27 @@ QVariant JsonlStore::data(const QModelIndex &index, int role) const
     case PreviewRole:    return entry.preview;
     case RoleNameRole:   return entry.role;
     case HasToolUseRole: return entry.hasToolUse;
-    case FullJsonRole:   return QString::fromUtf8(
-        QJsonDocument(entry.data).toJson(QJsonDocument::Indented));
-    case IsExpandedRole: return m_expandedRows.contains(index.row());
+    case IsExpandedRole: return m_expandedRows.contains(m_filteredIndices[index.row()]);
+    case FullJsonRole:
+    case JsonTruncatedRole: {
+        // Collapsed cards never show JSON — don't render it for them
+        const int source = m_filteredIndices[index.row()];
+        if (!m_expandedRows.contains(source))
+            return role == FullJsonRole ? QVariant(QString()) : QVariant(false);
+
+        const QString json = cachedEntryJson(source);
+        const int limit = m_jsonLimits.value(source, kJsonInitialChars);
+        if (role == JsonTruncatedRole)
+            return json.size() > limit;
+        if (json.size() <= limit)
+            return json;
+
+        // Cut at a line break so the visible part stays well-formed per line
+        const qsizetype cut = json.lastIndexOf(QLatin1Char('\n'), limit);
+        return json.left(cut > 0 ? cut : limit);
+    }
+    case HasParentRole:  return m_parentIndex.value(m_filteredIndices[index.row()], -1) >= 0;
+    case ChildCountRole: return m_childCount.value(m_filteredIndices[index.row()], 0);
     }
     return {};
 }
@@ -273,7 +533,10 @@ QHash<int, QByteArray> JsonlStore::roleNames() const
         { RoleNameRole,   "roleName" },
         { HasToolUseRole, "hasToolUse" },
         { FullJsonRole,   "fullJson" },
-        { IsExpandedRole, "isExpanded" }
+        { IsExpandedRole, "isExpanded" },
+        { JsonTruncatedRole, "jsonTruncated" },
+        { HasParentRole,  "hasParent" },
+        { ChildCountRole, "childCount" }
     };
 }
 
@@ -289,6 +552,18 @@ void JsonlStore::setTextFilter(const QString &text)
 {
     if (m_textFilter == text) return;
     m_textFilter = text;
+
+    // JSON escapes only quotes, backslashes and control characters, so a raw
+    // line without other ASCII needles cannot hold them in its text either
+    m_textMatcher = TextSearch::Matcher(text);
+    m_textFilterRaw = !text.isEmpty();
+    for (QChar c : text) {
+        if (c.unicode() < 0x20 || c.unicode() > 0x7E || c == u'"' || c == u'\\') {
+            m_textFilterRaw = false;
+            break;
+        }
+    }
+
     emit textFilterChanged();
     rebuildFiltered();
 }
@@ -311,20 +586,71 @@ void JsonlStore::setToolUseOnly(bool only)
     rebuildFiltered();
 }
 
+QString JsonlStore::query() const { return m_query; }
+void JsonlStore::setQuery(const QString &query)
+{
+    if (m_query == query) return;
+    m_query = query;
+    emit queryChanged();
+
+    // A query that does not compile is ignored until it is fixed
+    QString error;
+    m_compiledQuery = JsonlQuery::compile(query, &error);
+    if (m_queryError != error) {
+        m_queryError = error;
+        emit queryErrorChanged();
+    }
+    rebuildFiltered();
+}
+
+QString JsonlStore::queryError() const { return m_queryError; }
+
+bool JsonlStore::following() const { return m_following; }
+void JsonlStore::setFollowing(bool follow)
+{
+    if (m_following == follow) return;
+    m_following = follow;
+    emit followingChanged();
+
+    // Catch up on anything appended while follow mode was off
+    if (m_following && !m_filePath.isEmpty())
+        m_appendTimer.start();
+    else
+        m_appendTimer.stop();
+}
+
 void JsonlStore::load(const QString &filePath)
 {
     stopWorker();
     clear();
 
+    // Entries only keep offsets — the store reads full JSON from this view on demand
+    if (!m_file.open(filePath)) {
+        emit loadFailed(QStringLiteral("Could not open file: ") + filePath);
+        return;
+    }
+
     m_generation++;
-    m_workerCancel = std::make_shared<std::atomic<bool>>(false);
     m_filePath = filePath;
     emit filePathChanged();
 
+    m_watcher.addPath(filePath);
+
     m_loading = true;
     emit loadingChanged();
 
-    auto *worker = new JsonlWorker(filePath, m_generation, m_workerCancel);
+    startWorker(0, 0);
+}
+
+void JsonlStore::startWorker(qint64 startOffset, int startLine)
+{
+    m_workerCancel = std::make_shared<std::atomic<bool>>(false);
+
+    const QString cachePath = m_cacheDir.isEmpty()
+        ? QString() : JsonlIndexCache::cachePathFor(m_cacheDir, m_filePath);
+    auto *worker = new JsonlWorker(m_filePath, startOffset, startLine,
+                                   m_following || startOffset > 0, cachePath,
+                                   m_generation, m_workerCancel);
     m_workerThread = new QThread();
     worker->moveToThread(m_workerThread);
 
@@ -346,10 +672,44 @@ void JsonlStore::load(const QString &filePath)
 
 void JsonlStore::clear()
 {
+    // Drop the running worker and any chunks it already queued
+    stopWorker();
+    m_generation++;
+    if (m_loading) {
+        m_loading = false;
+        emit loadingChanged();
+    }
+
     beginResetModel();
     m_entries.clear();
+    m_textIndex.clear();
+    m_roleBits.clear();
+    m_toolUseBits.clear();
+    m_pendingToolNames.clear();
+    m_usage->reset();
+    m_uuidIndex.clear();
+    m_parentIndex.clear();
+    m_childCount.clear();
+    m_childStart.clear();
+    m_children.clear();
+    m_childListsDirty = true;
+    const bool hadThread = m_threadRoot >= 0;
+    m_threadRoot = -1;
+    m_threadMembers.clear();
+    m_threadDescendants.clear();
+    m_file.close();
+    if (!m_watcher.files().isEmpty())
+        m_watcher.removePaths(m_watcher.files());
+    m_appendTimer.stop();
+    m_appendPending = false;
+    m_tailOffset = 0;
+    m_tailLine = 0;
+    m_tailCheck.clear();
+    m_tailModified = QDateTime();
     m_filteredIndices.clear();
     m_expandedRows.clear();
+    m_jsonLimits.clear();
+    m_jsonCache.clear();
     m_availableRoles.clear();
     m_filePath.clear();
     m_loadProgress = 0;
@@ -360,26 +720,216 @@ void JsonlStore::clear()
     emit filteredCountChanged();
     emit availableRolesChanged();
     emit loadProgressChanged();
+    if (hadThread)
+        emit threadFilterChanged();
 }
 
 void JsonlStore::toggleExpanded(int index)
 {
     if (index < 0 || index >= m_filteredIndices.size()) return;
 
-    if (m_expandedRows.contains(index))
-        m_expandedRows.remove(index);
-    else
-        m_expandedRows.insert(index);
+    const int source = m_filteredIndices[index];
+    if (m_expandedRows.contains(source)) {
+        m_expandedRows.remove(source);
+        m_jsonLimits.remove(source);
+    } else {
+        m_expandedRows.insert(source);
+    }
+
+    QModelIndex mi = createIndex(index, 0);
+    emit dataChanged(mi, mi, { IsExpandedRole, FullJsonRole, JsonTruncatedRole });
+}
+
+void JsonlStore::showMoreJson(int index)
+{
+    if (index < 0 || index >= m_filteredIndices.size()) return;
+
+    // Grow the visible part geometrically so huge tool results page in quickly
+    const int source = m_filteredIndices[index];
+    const int limit = m_jsonLimits.value(source, kJsonInitialChars);
+    m_jsonLimits.insert(source, int(qMin<qint64>(qint64(limit) * 4, std::numeric_limits<int>::max())));
 
     QModelIndex mi = createIndex(index, 0);
-    emit dataChanged(mi, mi, { IsExpandedRole });
+    emit dataChanged(mi, mi, { FullJsonRole, JsonTruncatedRole });
 }
 
 QString JsonlStore::entryJson(int index) const
 {
     if (index < 0 || index >= m_filteredIndices.size()) return {};
-    const JsonlEntry &entry = m_entries[m_filteredIndices[index]];
-    return QString::fromUtf8(QJsonDocument(entry.data).toJson(QJsonDocument::Indented));
+    return cachedEntryJson(m_filteredIndices[index]);
+}
+
+// ── Conversation tree ────────────────────────────────────────
+
+bool JsonlStore::threadFiltered() const { return m_threadRoot >= 0; }
+
+JsonlUsageModel *JsonlStore::usage() const { return m_usage; }
+
+int JsonlStore::rowForSource(int source) const
+{
+    const auto it = std::lower_bound(m_filteredIndices.cbegin(), m_filteredIndices.cend(), source);
+    if (it == m_filteredIndices.cend() || *it != source)
+        return -1;
+    return int(it - m_filteredIndices.cbegin());
+}
+
+void JsonlStore::ensureChildLists() const
+{
+    if (!m_childListsDirty)
+        return;
+
+    // Counting sort by parent: one pass for offsets, one to place children
+    const int count = m_parentIndex.size();
+    m_childStart.fill(0, count + 1);
+    for (int i = 0; i < count; ++i)
+        m_childStart[i + 1] = m_childStart[i] + m_childCount[i];
+
+    m_children.resize(m_childStart[count]);
+    QVector<int> next(m_childStart.cbegin(), m_childStart.cend() - 1);
+    for (int i = 0; i < count; ++i) {
+        const int parent = m_parentIndex[i];
+        if (parent >= 0)
+            m_children[next[parent]++] = i;
+    }
+    m_childListsDirty = false;
+}
+
+QVector<int> JsonlStore::descendantsOf(int source) const
+{
+    ensureChildLists();
+
+    QVector<int> result;
+    QVector<int> stack { source };
+    while (!stack.isEmpty()) {
+        const int i = stack.takeLast();
+        for (int c = m_childStart[i]; c < m_childStart[i + 1]; ++c) {
+            result.append(m_children[c]);
+            stack.append(m_children[c]);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+int JsonlStore::parentRow(int index) const
+{
+    if (index < 0 || index >= m_filteredIndices.size()) return -1;
+
+    // Nearest ancestor that the current filter shows
+    for (int parent = m_parentIndex.value(m_filteredIndices[index], -1); parent >= 0;
+         parent = m_parentIndex[parent]) {
+        const int row = rowForSource(parent);
+        if (row >= 0)
+            return row;
+    }
+    return -1;
+}
+
+QVariantList JsonlStore::ancestorRows(int index) const
+{
+    QVariantList rows;
+    if (index < 0 || index >= m_filteredIndices.size()) return rows;
+
+    for (int parent = m_parentIndex.value(m_filteredIndices[index], -1); parent >= 0;
+         parent = m_parentIndex[parent]) {
+        const int row = rowForSource(parent);
+        if (row >= 0)
+            rows.prepend(row);
+    }
+    return rows;
+}
+
+QVariantList JsonlStore::childRows(int index) const
+{
+    QVariantList rows;
+    if (index < 0 || index >= m_filteredIndices.size()) return rows;
+
+    ensureChildLists();
+    const int source = m_filteredIndices[index];
+    for (int c = m_childStart[source]; c < m_childStart[source + 1]; ++c) {
+        const int row = rowForSource(m_children[c]);
+        if (row >= 0)
+            rows.append(row);
+    }
+    return rows;
+}
+
+QVariantList JsonlStore::descendantRows(int index) const
+{
+    QVariantList rows;
+    if (index < 0 || index >= m_filteredIndices.size()) return rows;
+
+    for (int source : descendantsOf(m_filteredIndices[index])) {
+        const int row = rowForSource(source);
+        if (row >= 0)
+            rows.append(row);
+    }
+    return rows;
+}
+
+int JsonlStore::followThread(int index)
+{
+    if (index < 0 || index >= m_filteredIndices.size()) return -1;
+
+    const int root = m_filteredIndices[index];
+    const int count = m_entries.size();
+    m_threadMembers = QBitArray(count);
+    m_threadDescendants = QBitArray(count);
+
+    // Ancestors up to the conversation root
+    for (int parent = m_parentIndex.value(root, -1); parent >= 0; parent = m_parentIndex[parent])
+        m_threadMembers.setBit(parent);
+
+    m_threadMembers.setBit(root);
+    m_threadDescendants.setBit(root);
+    for (int source : descendantsOf(root)) {
+        m_threadMembers.setBit(source);
+        m_threadDescendants.setBit(source);
+    }
+
+    const bool changed = m_threadRoot < 0;
+    m_threadRoot = root;
+    if (changed)
+        emit threadFilterChanged();
+    rebuildFiltered();
+    return rowForSource(root);
+}
+
+void JsonlStore::clearThreadFilter()
+{
+    if (m_threadRoot < 0) return;
+    m_threadRoot = -1;
+    m_threadMembers.clear();
+    m_threadDescendants.clear();
+    emit threadFilterChanged();
+    rebuildFiltered();
+}
+
+QString JsonlStore::cachedEntryJson(int source) const
+{
+    if (const QString *cached = m_jsonCache.object(source))
+        return *cached;
+
+    const QString json = renderEntryJson(m_entries[source]);
+    const qsizetype bytes = json.size() * qsizetype(sizeof(QChar));
+    if (bytes <= kJsonCacheBytes)
+        m_jsonCache.insert(source, new QString(json), bytes);
+    return json;
+}
+
+QString JsonlStore::renderEntryJson(const JsonlEntry &entry) const
+{
+    // Read rather than slice the mapping: the log may have been truncated
+    // since it was indexed, and its mapped pages would then fault
+    const QByteArray line = m_file.read(entry.offset, entry.length);
+    QJsonParseError parseErr;
+    const QJsonDocument doc = QJsonDocument::fromJson(line, &parseErr);
+
+    // Unparseable lines are shown as-is so the broken text stays inspectable
+    if (parseErr.error != QJsonParseError::NoError || !doc.isObject())
+        return QString::fromUtf8(line);
+
+    return QString::fromUtf8(doc.toJson(QJsonDocument::Indented));
 }
 
 void JsonlStore::copyEntry(int index)
@@ -397,13 +947,79 @@ void JsonlStore::copyEntry(int index)
     }
 }
 
-void JsonlStore::appendChunk(const QVector<JsonlEntry> &entries, quint64 generation)
+void JsonlStore::appendChunk(const JsonlChunk &chunk, quint64 generation)
 {
     if (generation != m_generation) return;
+    const QVector<JsonlEntry> &entries = chunk.entries;
     QSet<QString> rolesBefore(m_availableRoles.begin(), m_availableRoles.end());
     int oldSize = m_entries.size();
     m_entries.append(entries);
 
+    // Appended lines may lie beyond the current mapping
+    if (!entries.isEmpty()) {
+        const JsonlEntry &last = entries.constLast();
+        if (last.offset + last.length > m_file.size())
+            m_file.remap();
+    }
+
+    // Link tool results to the tool_use that produced them
+    for (const JsonlToolCall &call : chunk.toolCalls) {
+        if (!call.name.isEmpty()) {
+            m_pendingToolNames.insert(call.id, call.name);
+            continue;
+        }
+        const QString name = m_pendingToolNames.take(call.id);
+        JsonlEntry &result = m_entries[oldSize + call.entry];
+        if (!name.isEmpty() && !result.tools.contains(name))
+            result.tools.append(name);
+    }
+
+    const int newSize = m_entries.size();
+
+    m_usage->addRecords(chunk.usage);
+
+    // Conversation tree — a reply inside the followed thread joins the filter
+    if (m_threadRoot >= 0) {
+        m_threadMembers.resize(newSize);
+        m_threadDescendants.resize(newSize);
+    }
+    QSet<int> grownParents;          // already listed entries that gained a reply
+    for (int i = oldSize; i < newSize; ++i) {
+        const JsonlEntry &e = m_entries[i];
+        const int parent = e.parentUuid.isNull() ? -1 : m_uuidIndex.value(e.parentUuid, -1);
+        if (!e.uuid.isNull() && !m_uuidIndex.contains(e.uuid))
+            m_uuidIndex.insert(e.uuid, i);
+
+        m_parentIndex.append(parent);
+        m_childCount.append(0);
+        if (parent < 0)
+            continue;
+        m_childCount[parent]++;
+        if (parent < oldSize)
+            grownParents.insert(parent);
+        if (m_threadRoot >= 0 && m_threadDescendants.testBit(parent)) {
+            m_threadDescendants.setBit(i);
+            m_threadMembers.setBit(i);
+        }
+    }
+    m_childListsDirty = true;
+
+    // Extend the filter indexes
+    JsonlTextIndex::Segment segment = chunk.textIndex;
+    segment.firstEntry = oldSize;
+    m_textIndex.append(std::move(segment));
+
+    m_toolUseBits.resize(newSize);
+    for (int i = oldSize; i < newSize; ++i) {
+        const JsonlEntry &e = m_entries[i];
+        QBitArray &bits = m_roleBits[e.role];
+        if (bits.size() < newSize)
+            bits.resize(newSize);
+        bits.setBit(i);
+        if (e.hasToolUse)
+            m_toolUseBits.setBit(i);
+    }
+
     // Track new roles
     for (const auto &e : entries) {
         if (!e.role.isEmpty() && e.role != QStringLiteral("error"))
@@ -418,14 +1034,7 @@ void JsonlStore::appendChunk(const QVector<JsonlEntry> &entries, quint64 generat
     }
 
     // Collect matching indices first, then insert as a single batch
-    QVector<int> newFiltered;
-    for (int i = oldSize; i < m_entries.size(); ++i) {
-        const auto &e = m_entries[i];
-        if (!m_roleFilter.isEmpty() && e.role != m_roleFilter) continue;
-        if (m_toolUseOnly && !e.hasToolUse) continue;
-        if (!m_textFilter.isEmpty() && !e.preview.contains(m_textFilter, Qt::CaseInsensitive)) continue;
-        newFiltered.append(i);
-    }
+    const QVector<int> newFiltered = matchingIndices(oldSize);
 
     int addedCount = newFiltered.size();
     if (addedCount > 0) {
@@ -436,18 +1045,38 @@ void JsonlStore::appendChunk(const QVector<JsonlEntry> &entries, quint64 generat
         endInsertRows();
     }
 
+    for (int parent : std::as_const(grownParents)) {
+        const int row = rowForSource(parent);
+        if (row >= 0) {
+            const QModelIndex mi = createIndex(row, 0);
+            emit dataChanged(mi, mi, { ChildCountRole });
+        }
+    }
+
     emit totalCountChanged();
     if (addedCount > 0)
         emit filteredCountChanged();
 }
 
-void JsonlStore::onLoadFinished(quint64 generation)
+void JsonlStore::onLoadFinished(quint64 generation, qint64 endOffset, int lineCount)
 {
     if (generation != m_generation) return;
-    m_loading = false;
     m_workerThread = nullptr; // already scheduled for deleteLater
     m_workerCancel.reset();
-    emit loadingChanged();
+    m_tailOffset = endOffset;
+    m_tailLine = lineCount;
+    m_tailCheck = readTail(m_filePath, m_tailOffset);
+    m_tailModified = QFileInfo(m_filePath).lastModified();
+
+    if (m_loading) {
+        m_loading = false;
+        emit loadingChanged();
+    }
+
+    if (m_appendPending) {
+        m_appendPending = false;
+        m_appendTimer.start();
+    }
 }
 
 void JsonlStore::onLoadError(const QString &message, quint64 generation)
@@ -456,24 +1085,179 @@ void JsonlStore::onLoadError(const QString &message, quint64 generation)
     emit loadFailed(message);
 }
 
+void JsonlStore::onFileChanged()
+{
+    // Some platforms drop the watch after a change notification
+    if (!m_filePath.isEmpty() && !m_watcher.files().contains(m_filePath)
+        && QFileInfo::exists(m_filePath))
+        m_watcher.addPath(m_filePath);
+
+    if (m_following)
+        m_appendTimer.start();
+}
+
+void JsonlStore::checkForAppend()
+{
+    if (!m_following || m_filePath.isEmpty())
+        return;
+
+    // Never run two workers at once — re-check when the current one finishes
+    if (m_workerThread) {
+        m_appendPending = true;
+        return;
+    }
+
+    const QFileInfo info(m_filePath);
+    if (!info.exists())
+        return;
+
+    const qint64 size = info.size();
+    if (size == m_tailOffset && info.lastModified() <= m_tailModified)
+        return;
+
+    // Truncated or rewritten (the bytes before the resume point changed), or
+    // a one-shot load ended inside a line that is still being written —
+    // offsets are stale, start over (filters persist). load() clears
+    // m_filePath, so pass a copy.
+    const bool midLine = !m_tailCheck.isEmpty() && !m_tailCheck.endsWith('\n')
+        && m_tailCheck != QByteArrayView("\xEF\xBB\xBF");
+    if (size < m_tailOffset || midLine || readTail(m_filePath, m_tailOffset) != m_tailCheck) {
+        const QString path = m_filePath;
+        load(path);
+        return;
+    }
+    if (size == m_tailOffset)
+        return;
+
+    startWorker(m_tailOffset, m_tailLine);
+}
+
 void JsonlStore::rebuildFiltered()
 {
-    beginResetModel();
-    m_filteredIndices.clear();
-    m_expandedRows.clear();
+    const QVector<int> next = matchingIndices(0);
+    const QVector<int> &prev = m_filteredIndices;
+
+    // Both lists are ascending source indices — one merge pass yields the
+    // removed runs (old rows) and inserted runs (new rows)
+    struct Run {
+        int first;
+        int last;
+    };
+    QVector<Run> removed, inserted;
+    auto extend = [](QVector<Run> &runs, int row) {
+        if (!runs.isEmpty() && runs.last().last == row - 1)
+            runs.last().last = row;
+        else
+            runs.append({row, row});
+    };
+
+    int i = 0, j = 0;
+    while (i < prev.size() || j < next.size()) {
+        if (j == next.size() || (i < prev.size() && prev[i] < next[j])) {
+            extend(removed, i++);
+        } else if (i == prev.size() || next[j] < prev[i]) {
+            extend(inserted, j++);
+        } else {
+            ++i;
+            ++j;
+        }
+    }
+
+    if (removed.isEmpty() && inserted.isEmpty())
+        return;
 
-    for (int i = 0; i < m_entries.size(); ++i) {
-        const auto &e = m_entries[i];
-        if (!m_roleFilter.isEmpty() && e.role != m_roleFilter) continue;
-        if (m_toolUseOnly && !e.hasToolUse) continue;
-        if (!m_textFilter.isEmpty() && !e.preview.contains(m_textFilter, Qt::CaseInsensitive)) continue;
-        m_filteredIndices.append(i);
+    // Heavily fragmented changes are cheaper for the view as one reset
+    constexpr int kMaxIncrementalRuns = 2000;
+    if (removed.size() + inserted.size() > kMaxIncrementalRuns) {
+        beginResetModel();
+        m_filteredIndices = next;
+        endResetModel();
+        emit filteredCountChanged();
+        return;
+    }
+
+    // Remove back to front so earlier row numbers stay valid
+    for (auto it = removed.crbegin(); it != removed.crend(); ++it) {
+        beginRemoveRows({}, it->first, it->last);
+        m_filteredIndices.remove(it->first, it->last - it->first + 1);
+        endRemoveRows();
+    }
+
+    // Insert front to back; each run's rows are final positions in `next`
+    for (const Run &run : std::as_const(inserted)) {
+        beginInsertRows({}, run.first, run.last);
+        m_filteredIndices.insert(run.first, run.last - run.first + 1, 0);
+        std::copy(next.cbegin() + run.first, next.cbegin() + run.last + 1,
+                  m_filteredIndices.begin() + run.first);
+        endInsertRows();
     }
 
-    endResetModel();
     emit filteredCountChanged();
 }
 
+QVector<int> JsonlStore::matchingIndices(int from) const
+{
+    const int count = m_entries.size();
+
+    // Role and tool-use filters are bitmap intersections; the query tests columns
+    QBitArray mask;
+    if (!m_roleFilter.isEmpty()) {
+        mask = m_roleBits.value(m_roleFilter);
+        mask.resize(count);
+    }
+    if (m_toolUseOnly) {
+        QBitArray tools = m_toolUseBits;
+        tools.resize(count);
+        mask = mask.isNull() ? tools : (mask & tools);
+    }
+    if (m_threadRoot >= 0) {
+        QBitArray thread = m_threadMembers;
+        thread.resize(count);
+        mask = mask.isNull() ? thread : (mask & thread);
+    }
+    auto passes = [this, &mask](int i) {
+        return (mask.isNull() || mask.testBit(i)) && m_compiledQuery.matches(m_entries[i]);
+    };
+
+    QVector<int> result;
+    if (m_textFilter.isEmpty()) {
+        for (int i = from; i < count; ++i) {
+            if (passes(i))
+                result.append(i);
+        }
+    } else if (JsonlTextIndex::canLookup(m_textFilter)) {
+        // Index lookup narrows to entries holding every trigram of the needle
+        const bool exact = JsonlTextIndex::isExactLookup(m_textFilter);
+        for (int i : m_textIndex.candidates(m_textFilter, from)) {
+            if (passes(i) && ((exact && !m_textIndex.isTruncated(i))
+                              || entryMatchesText(m_entries[i])))
+                result.append(i);
+        }
+    } else {
+        // Too short for a trigram — match previews only
+        for (int i = from; i < count; ++i) {
+            if (passes(i) && m_textMatcher.matches(m_entries[i].preview))
+                result.append(i);
+        }
+    }
+    return result;
+}
+
+bool JsonlStore::entryMatchesText(const JsonlEntry &entry) const
+{
+    if (m_textMatcher.matches(entry.preview))
+        return true;
+
+    // The raw line only rules entries out: keys, ids and escapes such as
+    // "\n" would match there without being part of the text
+    const QByteArray line = m_file.read(entry.offset, entry.length);
+    if (m_textFilterRaw && !m_textMatcher.matches(line))
+        return false;
+
+    const QJsonDocument doc = QJsonDocument::fromJson(line);
+    return doc.isObject() && m_textMatcher.matches(JsonlTextIndex::searchableText(doc.object()));
+}
+
 void JsonlStore::stopWorker()
 {
     if (m_workerCancel)
@@ -1,26 +1,73 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QBitArray>
+#include <QCache>
+#include <QDateTime>
+#include <QFileSystemWatcher>
 #include <QJsonObject>
 #include <QThread>
+#include <QTimer>
+#include <QUuid>
 #include <QtQml/qqmlregistration.h>
 #include <atomic>
 #include <memory>
 
+#include "jsonlquery.h"
+#include "jsonltextindex.h"
+#include "jsonlusage.h"
+#include "mappedfile.h"
+#include "textsearch.h"
+
+// Compact per-line summary. The full JSON is not kept in memory — it is
+// re-parsed from the mapped file on demand via offset/length. The remaining
+// fields are extracted once by the worker so queries never re-parse lines.
 struct JsonlEntry {
-    int lineNumber;
-    QJsonObject data;
+    qint64 offset = 0;       // byte offset of the (trimmed) line in the file
+    int length = 0;          // byte length of the (trimmed) line
+    int lineNumber = 0;
     QString preview;
     QString role;
     bool hasToolUse = false;
+    bool isError = false;    // failed tool result or unparseable line
+    qint64 timestamp = 0;    // ms since epoch, 0 when the line has none
+    QString sessionId;
+    QString model;
+    QStringList tools;       // tools called, or the tool a result answers
+    QUuid uuid;
+    QUuid parentUuid;
+};
+
+// tool_use block, or a tool_result that refers back to one by id. Results only
+// carry the id; the store fills in the tool name once both sides are loaded.
+struct JsonlToolCall {
+    int entry = 0;           // index within the chunk
+    QString id;
+    QString name;            // empty for a result
+};
+
+// A batch of consecutive entries plus the text index segment covering them
+struct JsonlChunk {
+    QVector<JsonlEntry> entries;
+    JsonlTextIndex::Segment textIndex;   // local indices; the store sets firstEntry
+    QVector<JsonlToolCall> toolCalls;
+    QVector<JsonlUsageRecord> usage;
 };
 
-// Worker that parses JSONL on a background thread
+// Worker that parses JSONL on a background thread. The file is split into
+// newline-aligned byte ranges that are parsed concurrently on the global
+// thread pool and emitted in line order. A non-zero start offset parses only
+// the bytes appended since a previous run (tail-follow). Each range also builds
+// the text index segment for its lines. With a cache path, a full run first
+// replays the sidecar index and the results are written back.
 class JsonlWorker : public QObject
 {
     Q_OBJECT
 public:
-    explicit JsonlWorker(const QString &filePath, quint64 generation,
+    // holdPartialLine: leave an unparsable last line without a newline for
+    // the next run (follow mode); otherwise it shows as a parse error
+    explicit JsonlWorker(const QString &filePath, qint64 startOffset, int startLine,
+                         bool holdPartialLine, const QString &cachePath, quint64 generation,
                          const std::shared_ptr<std::atomic<bool>> &cancelFlag,
                          QObject *parent = nullptr);
 
@@ -30,13 +77,18 @@ public slots:
     void process();
 
 signals:
-    void chunkReady(const QVector<JsonlEntry> &entries, quint64 generation);
+    void chunkReady(const JsonlChunk &chunk, quint64 generation);
     void progressChanged(int current, quint64 generation);
-    void finished(quint64 generation);
+    // endOffset/lineCount mark where the next incremental run should resume
+    void finished(quint64 generation, qint64 endOffset, int lineCount);
     void error(const QString &message, quint64 generation);
 
 private:
     QString m_filePath;
+    qint64 m_startOffset;
+    int m_startLine;
+    bool m_holdPartialLine;
+    QString m_cachePath;
     quint64 m_generation;
     std::shared_ptr<std::atomic<bool>> m_cancelFlag;
 };
@@ -56,6 +108,11 @@ class JsonlStore : public QAbstractListModel
     Q_PROPERTY(QString textFilter READ textFilter WRITE setTextFilter NOTIFY textFilterChanged)
     Q_PROPERTY(QString roleFilter READ roleFilter WRITE setRoleFilter NOTIFY roleFilterChanged)
     Q_PROPERTY(bool toolUseOnly READ toolUseOnly WRITE setToolUseOnly NOTIFY toolUseOnlyChanged)
+    Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged)
+    Q_PROPERTY(QString queryError READ queryError NOTIFY queryErrorChanged)
+    Q_PROPERTY(bool following READ following WRITE setFollowing NOTIFY followingChanged)
+    Q_PROPERTY(bool threadFiltered READ threadFiltered NOTIFY threadFilterChanged)
+    Q_PROPERTY(JsonlUsageModel* usage READ usage CONSTANT)
 
 public:
     enum Roles {
@@ -64,11 +121,15 @@ public:
         RoleNameRole,
         HasToolUseRole,
         FullJsonRole,
-        IsExpandedRole
+        IsExpandedRole,
+        JsonTruncatedRole,
+        HasParentRole,
+        ChildCountRole
     };
     Q_ENUM(Roles)
 
-    explicit JsonlStore(QObject *parent = nullptr);
+    // cacheDir: folder for sidecar indexes (empty disables caching)
+    explicit JsonlStore(const QString &cacheDir, QObject *parent = nullptr);
     ~JsonlStore() override;
 
     int rowCount(const QModelIndex &parent = {}) const override;
@@ -88,13 +149,31 @@ public:
     void setRoleFilter(const QString &role);
     bool toolUseOnly() const;
     void setToolUseOnly(bool only);
+    QString query() const;
+    void setQuery(const QString &query);
+    QString queryError() const;
+    bool following() const;
+    void setFollowing(bool follow);
+    bool threadFiltered() const;
+    JsonlUsageModel *usage() const;
 
     Q_INVOKABLE void load(const QString &filePath);
     Q_INVOKABLE void clear();
     Q_INVOKABLE void toggleExpanded(int index);
+    Q_INVOKABLE void showMoreJson(int index);
     Q_INVOKABLE QString entryJson(int index) const;
     Q_INVOKABLE void copyEntry(int index);
 
+    // Conversation tree navigation. Arguments and results are rows of the
+    // filtered model; entries hidden by the current filter are skipped.
+    Q_INVOKABLE int parentRow(int index) const;
+    Q_INVOKABLE QVariantList ancestorRows(int index) const;
+    Q_INVOKABLE QVariantList childRows(int index) const;
+    Q_INVOKABLE QVariantList descendantRows(int index) const;
+    // Show only the entry's ancestors and descendants; returns its new row
+    Q_INVOKABLE int followThread(int index);
+    Q_INVOKABLE void clearThreadFilter();
+
 signals:
     void filePathChanged();
     void totalCountChanged();
@@ -105,22 +184,40 @@ signals:
     void textFilterChanged();
     void roleFilterChanged();
     void toolUseOnlyChanged();
+    void queryChanged();
+    void queryErrorChanged();
+    void followingChanged();
+    void threadFilterChanged();
     void loadFailed(const QString &error);
     void copied(const QString &preview);
 
 private slots:
-    void appendChunk(const QVector<JsonlEntry> &entries, quint64 generation);
-    void onLoadFinished(quint64 generation);
+    void appendChunk(const JsonlChunk &chunk, quint64 generation);
+    void onLoadFinished(quint64 generation, qint64 endOffset, int lineCount);
     void onLoadError(const QString &message, quint64 generation);
+    void onFileChanged();
+    void checkForAppend();
 
 private:
+    void startWorker(qint64 startOffset, int startLine);
     void rebuildFiltered();
+    QVector<int> matchingIndices(int from) const;
+    bool entryMatchesText(const JsonlEntry &entry) const;
     void stopWorker();
+    QString renderEntryJson(const JsonlEntry &entry) const;
+    QString cachedEntryJson(int source) const;
+    int rowForSource(int source) const;
+    void ensureChildLists() const;
+    QVector<int> descendantsOf(int source) const;
 
+    QString m_cacheDir;
     QString m_filePath;
+    MappedFile m_file;               // source bytes for on-demand entry parsing
     QVector<JsonlEntry> m_entries;
     QVector<int> m_filteredIndices;
-    QSet<int> m_expandedRows;        // indices into m_filteredIndices
+    QSet<int> m_expandedRows;        // source indices into m_entries, survive filter changes
+    QHash<int, int> m_jsonLimits;    // source index -> characters of JSON shown when expanded
+    mutable QCache<int, QString> m_jsonCache;   // rendered JSON by source index, cost in bytes
     QStringList m_availableRoles;
     bool m_loading = false;
     int m_loadProgress = 0;
@@ -128,8 +225,43 @@ private:
     QString m_textFilter;
     QString m_roleFilter;
     bool m_toolUseOnly = false;
+    TextSearch::Matcher m_textMatcher;
+    bool m_textFilterRaw = false;    // a raw line without the needle cannot match
+    QString m_query;
+    QString m_queryError;
+    JsonlQuery m_compiledQuery;
+
+    // Filter indexes, grown with every appended chunk
+    JsonlTextIndex m_textIndex;
+    QHash<QString, QBitArray> m_roleBits;
+    QBitArray m_toolUseBits;
+    JsonlUsageModel *m_usage = nullptr;      // token/cost totals of the open transcript
+    QHash<QString, QString> m_pendingToolNames;   // tool_use id -> name until its result arrives
+
+    // Conversation tree from uuid/parentUuid. Parents are resolved as their
+    // children are appended, so a parent index is always below its child's
+    // (no cycles). Child lists are packed into one array on demand.
+    QHash<QUuid, int> m_uuidIndex;
+    QVector<int> m_parentIndex;      // per entry, -1 for roots and unknown parents
+    QVector<int> m_childCount;
+    mutable QVector<int> m_childStart;   // children of i: m_children[m_childStart[i] .. m_childStart[i + 1])
+    mutable QVector<int> m_children;
+    mutable bool m_childListsDirty = true;
+    int m_threadRoot = -1;           // followed entry, -1 when the thread filter is off
+    QBitArray m_threadMembers;       // ancestors and descendants of m_threadRoot
+    QBitArray m_threadDescendants;   // m_threadRoot and its subtree
 
     QThread *m_workerThread = nullptr;
     std::shared_ptr<std::atomic<bool>> m_workerCancel;
     quint64 m_generation = 0;
+
+    // Tail-follow: resume point after the last fully parsed line
+    bool m_following = false;
+    bool m_appendPending = false;    // file changed while a worker was running
+    qint64 m_tailOffset = 0;
+    int m_tailLine = 0;
+    QByteArray m_tailCheck;          // last bytes before m_tailOffset, to spot rewrites
+    QDateTime m_tailModified;        // mtime when m_tailOffset was reached
+    QFileSystemWatcher m_watcher;
+    QTimer m_appendTimer;            // coalesces bursts of watcher notifications
 };
@@ -0,0 +1,266 @@
+#include "jsonltextindex.h"
+
+#include <QJsonArray>
+#include <QStringList>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace {
+
+inline char16_t fold(QChar c)
+{
+    return c.toCaseFolded().unicode();
+}
+
+inline quint64 trigramKey(char16_t a, char16_t b, char16_t c)
+{
+    return (quint64(a) << 32) | (quint64(b) << 16) | quint64(c);
+}
+
+// Sorted, de-duplicated trigram keys of the first `limit` characters
+void collectTrigrams(QStringView text, qsizetype limit, QVector<quint64> &keys)
+{
+    keys.clear();
+    const qsizetype n = qMin(text.size(), limit);
+    if (n < 3)
+        return;
+
+    keys.reserve(n - 2);
+    char16_t a = fold(text[0]);
+    char16_t b = fold(text[1]);
+    for (qsizetype i = 2; i < n; ++i) {
+        const char16_t c = fold(text[i]);
+        keys.append(trigramKey(a, b, c));
+        a = b;
+        b = c;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+void appendVarint(QByteArray &out, quint32 value)
+{
+    while (value >= 0x80) {
+        out.append(char((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+void decodePostings(const char *p, const char *end, QVector<quint32> &out)
+{
+    out.clear();
+    qint64 current = -1;
+    while (p < end) {
+        quint32 delta = 0;
+        int shift = 0;
+        while (p < end) {
+            const quint8 byte = quint8(*p++);
+            delta |= quint32(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                break;
+            shift += 7;
+        }
+        current += delta;
+        out.append(quint32(current));
+    }
+}
+
+// Collect every string value below `value` (tool inputs are nested objects)
+void appendStrings(QStringList &parts, const QJsonValue &value)
+{
+    if (value.isString()) {
+        parts.append(value.toString());
+    } else if (value.isArray()) {
+        for (const QJsonValue &v : value.toArray())
+            appendStrings(parts, v);
+    } else if (value.isObject()) {
+        const QJsonObject obj = value.toObject();
+        for (auto it = obj.begin(); it != obj.end(); ++it)
+            appendStrings(parts, it.value());
+    }
+}
+
+void appendContent(QStringList &parts, const QJsonValue &content)
+{
+    if (content.isString()) {
+        parts.append(content.toString());
+        return;
+    }
+    if (!content.isArray())
+        return;
+
+    for (const QJsonValue &v : content.toArray()) {
+        if (!v.isObject()) continue;
+        const QJsonObject block = v.toObject();
+        const QString blockType = block.value(QStringLiteral("type")).toString();
+
+        if (blockType == QStringLiteral("text")) {
+            parts.append(block.value(QStringLiteral("text")).toString());
+        } else if (blockType == QStringLiteral("thinking")) {
+            parts.append(block.value(QStringLiteral("thinking")).toString());
+        } else if (blockType == QStringLiteral("tool_use")
+                   || blockType == QStringLiteral("server_tool_use")) {
+            parts.append(block.value(QStringLiteral("name")).toString());
+            appendStrings(parts, block.value(QStringLiteral("input")));
+        } else if (blockType == QStringLiteral("tool_result")) {
+            appendContent(parts, block.value(QStringLiteral("content")));
+        } else if (blockType == QStringLiteral("web_search_tool_result")) {
+            parts.append(block.value(QStringLiteral("search_query")).toString());
+        } else if (blockType == QStringLiteral("document")) {
+            parts.append(block.value(QStringLiteral("title")).toString());
+        }
+    }
+}
+
+} // namespace
+
+// ── SegmentBuilder ───────────────────────────────────────────
+
+void JsonlTextIndex::SegmentBuilder::addEntry(int localIndex, QStringView text)
+{
+    m_entryCount = qMax(m_entryCount, localIndex + 1);
+    if (text.size() > kMaxIndexedChars)
+        m_truncated.append(quint32(localIndex));
+    collectTrigrams(text, kMaxIndexedChars, m_scratch);
+    for (quint64 key : std::as_const(m_scratch)) {
+        Posting &posting = m_postings[key];
+        appendVarint(posting.bytes, quint32(localIndex - posting.last));
+        posting.last = localIndex;
+    }
+}
+
+JsonlTextIndex::Segment JsonlTextIndex::SegmentBuilder::finish()
+{
+    Segment segment;
+    segment.entryCount = m_entryCount;
+    segment.keys = m_postings.keys();
+    std::sort(segment.keys.begin(), segment.keys.end());
+
+    qsizetype total = 0;
+    for (auto it = m_postings.cbegin(); it != m_postings.cend(); ++it)
+        total += it->bytes.size();
+
+    segment.starts.reserve(segment.keys.size() + 1);
+    segment.postings.reserve(total);
+    for (quint64 key : std::as_const(segment.keys)) {
+        segment.starts.append(quint32(segment.postings.size()));
+        segment.postings.append(m_postings.value(key).bytes);
+    }
+    segment.starts.append(quint32(segment.postings.size()));
+    segment.truncated = std::exchange(m_truncated, {});
+
+    m_postings.clear();
+    m_entryCount = 0;
+    return segment;
+}
+
+// ── JsonlTextIndex ───────────────────────────────────────────
+
+QString JsonlTextIndex::searchableText(const QJsonObject &obj)
+{
+    QStringList parts;
+
+    // Claude Code JSONL nests the API message under "message"
+    const QJsonObject msg = obj.value(QStringLiteral("message")).toObject();
+    appendContent(parts, msg.isEmpty() ? obj.value(QStringLiteral("content"))
+                                       : msg.value(QStringLiteral("content")));
+
+    // Compaction summaries and hook progress keep their text at the top level
+    const QString summary = obj.value(QStringLiteral("summary")).toString();
+    if (!summary.isEmpty())
+        parts.append(summary);
+    const QJsonObject data = obj.value(QStringLiteral("data")).toObject();
+    if (!data.isEmpty())
+        appendStrings(parts, data);
+
+    parts.removeAll(QString());
+    return parts.join(QLatin1Char('\n'));
+}
+
+void JsonlTextIndex::append(Segment segment)
+{
+    if (segment.entryCount > 0)
+        m_segments.append(std::move(segment));
+}
+
+void JsonlTextIndex::clear()
+{
+    m_segments.clear();
+}
+
+QVector<int> JsonlTextIndex::candidates(QStringView needle, int fromEntry) const
+{
+    QVector<int> result;
+    QVector<quint64> keys;
+    collectTrigrams(needle, needle.size(), keys);
+    if (keys.isEmpty())
+        return result;
+
+    struct Range {
+        const char *begin;
+        const char *end;
+    };
+    QVector<Range> lists;
+    QVector<quint32> matches, decoded, next;
+
+    for (const Segment &seg : m_segments) {
+        if (seg.firstEntry + seg.entryCount <= fromEntry)
+            continue;
+
+        lists.clear();
+        for (quint64 key : std::as_const(keys)) {
+            const auto it = std::lower_bound(seg.keys.cbegin(), seg.keys.cend(), key);
+            if (it == seg.keys.cend() || *it != key)
+                break;
+            const qsizetype k = it - seg.keys.cbegin();
+            lists.append({seg.postings.constData() + seg.starts[k],
+                          seg.postings.constData() + seg.starts[k + 1]});
+        }
+
+        matches.clear();
+        if (lists.size() == keys.size()) {
+            // Intersect starting from the shortest posting list
+            std::sort(lists.begin(), lists.end(), [](const Range &a, const Range &b) {
+                return (a.end - a.begin) < (b.end - b.begin);
+            });
+            decodePostings(lists[0].begin, lists[0].end, matches);
+            for (qsizetype i = 1; i < lists.size() && !matches.isEmpty(); ++i) {
+                decodePostings(lists[i].begin, lists[i].end, decoded);
+                next.clear();
+                std::set_intersection(matches.cbegin(), matches.cend(),
+                                      decoded.cbegin(), decoded.cend(), std::back_inserter(next));
+                matches.swap(next);
+            }
+        }
+
+        // Truncated entries may hold the needle past the indexed prefix
+        if (!seg.truncated.isEmpty()) {
+            next.clear();
+            std::set_union(matches.cbegin(), matches.cend(),
+                           seg.truncated.cbegin(), seg.truncated.cend(), std::back_inserter(next));
+            matches.swap(next);
+        }
+
+        for (quint32 local : std::as_const(matches)) {
+            const int index = seg.firstEntry + int(local);
+            if (index >= fromEntry)
+                result.append(index);
+        }
+    }
+    return result;
+}
+
+bool JsonlTextIndex::isTruncated(int entry) const
+{
+    // Segments are appended in entry order
+    const auto seg = std::upper_bound(m_segments.cbegin(), m_segments.cend(), entry,
+                                      [](int e, const Segment &s) { return e < s.firstEntry; });
+    if (seg == m_segments.cbegin())
+        return false;
+    const Segment &s = *std::prev(seg);
+    const int local = entry - s.firstEntry;
+    return local < s.entryCount
+        && std::binary_search(s.truncated.cbegin(), s.truncated.cend(), quint32(local));
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+// Trigram index over the searchable text of JSONL entries — message text,
+// thinking, tool inputs and tool results, not only the short preview.
+//
+// The index is a list of segments, one per parsed byte range, so the worker
+// builds them concurrently and the store only ever appends. A segment maps
+// each case-folded UTF-16 trigram to the entries containing it, stored as
+// varint deltas of entry indices local to the segment.
+class JsonlTextIndex
+{
+public:
+    // Text beyond this many characters of an entry is not indexed; such
+    // entries are recorded as truncated and are always candidates
+    static constexpr qsizetype kMaxIndexedChars = 64 * 1024;
+
+    struct Segment {
+        int firstEntry = 0;          // store index of local entry 0 (set on append)
+        int entryCount = 0;
+        QVector<quint64> keys;       // sorted trigram keys
+        QVector<quint32> starts;     // posting start per key, plus an end sentinel
+        QByteArray postings;         // varint-delta local entry indices
+        QVector<quint32> truncated;  // sorted local entries cut at kMaxIndexedChars
+    };
+
+    // Collects one segment. Entries must be added in increasing local order.
+    class SegmentBuilder
+    {
+    public:
+        void addEntry(int localIndex, QStringView text);
+        Segment finish();
+
+    private:
+        struct Posting {
+            QByteArray bytes;
+            int last = -1;
+        };
+        QHash<quint64, Posting> m_postings;
+        QVector<quint64> m_scratch;
+        QVector<quint32> m_truncated;
+        int m_entryCount = 0;
+    };
+
+    // Everything a text filter should be able to find in one parsed line
+    static QString searchableText(const QJsonObject &obj);
+
+    // Needles shorter than one trigram cannot be looked up
+    static bool canLookup(QStringView needle) { return needle.size() >= 3; }
+    // A single-trigram lookup needs no verification, except for entries
+    // whose text was truncated (see isTruncated)
+    static bool isExactLookup(QStringView needle) { return needle.size() == 3; }
+
+    void append(Segment segment);
+    void clear();
+
+    // Sorted store indices (>= fromEntry) whose indexed text contains every
+    // trigram of `needle`, plus every truncated entry. A superset of the real
+    // matches.
+    QVector<int> candidates(QStringView needle, int fromEntry = 0) const;
+
+    // The entry's text ran past kMaxIndexedChars, so its trigrams are partial
+    bool isTruncated(int entry) const;
+
+private:
+    QVector<Segment> m_segments;
+};
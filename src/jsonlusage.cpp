@@ -0,0 +1,375 @@
+#include "jsonlusage.h"
+#include "mappedfile.h"
+
+#include <QDirIterator>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QPointer>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+namespace {
+
+constexpr int kRecordBatch = 2000;
+
+// Anthropic list prices in USD per million tokens at standard context
+// length, from https://www.anthropic.com/pricing as of 2025-11-24. Matched
+// by model-id prefix (no entry is a prefix of another); ids not listed stay
+// unpriced rather than borrowing a family's rate. Cache writes (5-minute)
+// bill at 1.25x input, cache reads at 0.1x input.
+struct ModelPrice {
+    const char *prefix;
+    double input;
+    double output;
+};
+constexpr ModelPrice kPrices[] = {
+    { "claude-opus-4-5",       5.0,  25.0  },
+    { "claude-opus-4-1",      15.0,  75.0  },
+    { "claude-opus-4-2025",   15.0,  75.0  },   // claude-opus-4-20250514
+    { "claude-3-opus",        15.0,  75.0  },
+    { "claude-sonnet-4-5",     3.0,  15.0  },
+    { "claude-sonnet-4-2025",  3.0,  15.0  },   // claude-sonnet-4-20250514
+    { "claude-3-7-sonnet",     3.0,  15.0  },
+    { "claude-3-5-sonnet",     3.0,  15.0  },
+    { "claude-haiku-4-5",      1.0,   5.0  },
+    { "claude-3-5-haiku",      0.8,   4.0  },
+    { "claude-3-haiku",        0.25,  1.25 },
+};
+
+QString groupKey(const QString &value, const char *fallback)
+{
+    return value.isEmpty() ? QString::fromLatin1(fallback) : value;
+}
+
+// Stream one transcript, posting usage records in batches. Lines without a
+// "usage" key are skipped before any JSON parsing.
+void scanFile(const QString &path, const std::shared_ptr<std::atomic<bool>> &cancel,
+              const std::function<void(QVector<JsonlUsageRecord> &&)> &post)
+{
+    MappedFile file;
+    if (!file.open(path))
+        return;
+
+    const char *data = file.data();
+    const qint64 size = file.size();
+    QVector<JsonlUsageRecord> batch;
+    qint64 pos = 0;
+    int lines = 0;
+
+    while (pos < size) {
+        if ((++lines & 0xFF) == 0 && cancel->load())
+            return;
+
+        const char *nl = static_cast<const char *>(std::memchr(data + pos, '\n', size_t(size - pos)));
+        const qint64 end = nl ? qint64(nl - data) : size;
+        const QByteArray line = QByteArray::fromRawData(data + pos, end - pos);
+        pos = end + 1;
+
+        if (!QByteArrayView(line).contains("\"usage\""))
+            continue;
+
+        const QJsonDocument doc = QJsonDocument::fromJson(line);
+        JsonlUsageRecord record;
+        if (doc.isObject() && JsonlUsageRecord::fromJson(doc.object(), record)) {
+            batch.append(std::move(record));
+            if (batch.size() >= kRecordBatch)
+                post(std::exchange(batch, {}));
+        }
+    }
+    if (!batch.isEmpty())
+        post(std::move(batch));
+}
+
+} // namespace
+
+bool JsonlUsageRecord::fromJson(const QJsonObject &obj, JsonlUsageRecord &record)
+{
+    const QJsonObject msg = obj.value(QStringLiteral("message")).toObject();
+    const QJsonObject usage = msg.value(QStringLiteral("usage")).toObject();
+    if (usage.isEmpty())
+        return false;
+
+    record.messageId = msg.value(QStringLiteral("id")).toString();
+    record.sessionId = obj.value(QStringLiteral("sessionId")).toString();
+    record.model = msg.value(QStringLiteral("model")).toString();
+    record.inputTokens = usage.value(QStringLiteral("input_tokens")).toInteger();
+    record.outputTokens = usage.value(QStringLiteral("output_tokens")).toInteger();
+    record.cacheCreationTokens = usage.value(QStringLiteral("cache_creation_input_tokens")).toInteger();
+    record.cacheReadTokens = usage.value(QStringLiteral("cache_read_input_tokens")).toInteger();
+
+    const QJsonValue content = msg.value(QStringLiteral("content"));
+    for (const QJsonValue &v : content.toArray()) {
+        const QJsonObject block = v.toObject();
+        if (block.value(QStringLiteral("type")).toString() == QStringLiteral("tool_use"))
+            record.tools.append(block.value(QStringLiteral("name")).toString());
+    }
+    return true;
+}
+
+// ── JsonlUsageModel ──────────────────────────────────────────
+
+JsonlUsageModel::JsonlUsageModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    qRegisterMetaType<QVector<JsonlUsageRecord>>("QVector<JsonlUsageRecord>");
+
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(150);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &JsonlUsageModel::rebuildRows);
+}
+
+JsonlUsageModel::~JsonlUsageModel()
+{
+    if (m_scanCancel)
+        m_scanCancel->store(true);
+}
+
+int JsonlUsageModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_rows.size();
+}
+
+QVariant JsonlUsageModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size())
+        return {};
+
+    const auto &row = m_rows[index.row()];
+    const Totals &t = row.second;
+    switch (role) {
+    case NameRole:                return row.first;
+    case InputTokensRole:         return t.inputTokens;
+    case OutputTokensRole:        return t.outputTokens;
+    case CacheCreationTokensRole: return t.cacheCreationTokens;
+    case CacheReadTokensRole:     return t.cacheReadTokens;
+    case MessagesRole:            return t.messages;
+    case ToolCallsRole:           return t.toolCalls;
+    case CostRole:                return t.cost;
+    case UnpricedTokensRole:      return t.unpricedTokens;
+    }
+    return {};
+}
+
+QHash<int, QByteArray> JsonlUsageModel::roleNames() const
+{
+    return {
+        { NameRole,                "name" },
+        { InputTokensRole,         "inputTokens" },
+        { OutputTokensRole,        "outputTokens" },
+        { CacheCreationTokensRole, "cacheCreationTokens" },
+        { CacheReadTokensRole,     "cacheReadTokens" },
+        { MessagesRole,            "messages" },
+        { ToolCallsRole,           "toolCalls" },
+        { CostRole,                "cost" },
+        { UnpricedTokensRole,      "unpricedTokens" }
+    };
+}
+
+QString JsonlUsageModel::groupBy() const { return m_groupBy; }
+void JsonlUsageModel::setGroupBy(const QString &groupBy)
+{
+    if (m_groupBy == groupBy) return;
+    m_groupBy = groupBy;
+    emit groupByChanged();
+    rebuildRows();
+}
+
+QVariantMap JsonlUsageModel::totals() const
+{
+    return {
+        { QStringLiteral("inputTokens"),         m_total.inputTokens },
+        { QStringLiteral("outputTokens"),        m_total.outputTokens },
+        { QStringLiteral("cacheCreationTokens"), m_total.cacheCreationTokens },
+        { QStringLiteral("cacheReadTokens"),     m_total.cacheReadTokens },
+        { QStringLiteral("messages"),            m_total.messages },
+        { QStringLiteral("toolCalls"),           m_total.toolCalls },
+        { QStringLiteral("cost"),                m_total.cost },
+        { QStringLiteral("unpricedTokens"),      m_total.unpricedTokens }
+    };
+}
+
+bool JsonlUsageModel::busy() const { return m_busy; }
+int JsonlUsageModel::fileCount() const { return m_fileCount; }
+
+std::optional<double> JsonlUsageModel::costFor(const QString &model, qint64 input,
+                                               qint64 output, qint64 cacheCreation,
+                                               qint64 cacheRead)
+{
+    for (const ModelPrice &price : kPrices) {
+        if (!model.startsWith(QLatin1String(price.prefix), Qt::CaseInsensitive))
+            continue;
+        return (input * price.input + cacheCreation * price.input * 1.25
+                + cacheRead * price.input * 0.1 + output * price.output) / 1e6;
+    }
+    return std::nullopt;
+}
+
+void JsonlUsageModel::addRecords(const QVector<JsonlUsageRecord> &records)
+{
+    for (const JsonlUsageRecord &record : records) {
+        const Usage usage { record.inputTokens, record.outputTokens,
+                            record.cacheCreationTokens, record.cacheReadTokens };
+        if (record.messageId.isEmpty()) {
+            addToGroups(record, usage, true);
+            continue;
+        }
+
+        // Each content block of a message repeats its usage, and output counts
+        // grow while it streams — count the largest value seen, once
+        auto it = m_messageUsage.find(record.messageId);
+        if (it == m_messageUsage.end()) {
+            m_messageUsage.insert(record.messageId, usage);
+            addToGroups(record, usage, true);
+            continue;
+        }
+
+        Usage &seen = it.value();
+        const Usage delta { qMax<qint64>(0, usage.input - seen.input),
+                            qMax<qint64>(0, usage.output - seen.output),
+                            qMax<qint64>(0, usage.cacheCreation - seen.cacheCreation),
+                            qMax<qint64>(0, usage.cacheRead - seen.cacheRead) };
+        seen.input += delta.input;
+        seen.output += delta.output;
+        seen.cacheCreation += delta.cacheCreation;
+        seen.cacheRead += delta.cacheRead;
+        addToGroups(record, delta, false);
+    }
+
+    if (!records.isEmpty() && !m_refreshTimer.isActive())
+        m_refreshTimer.start();
+}
+
+void JsonlUsageModel::addToGroups(const JsonlUsageRecord &record, const Usage &delta, bool newMessage)
+{
+    const std::optional<double> cost = costFor(record.model, delta.input, delta.output,
+                                               delta.cacheCreation, delta.cacheRead);
+    const qint64 unpriced = cost ? 0
+        : delta.input + delta.output + delta.cacheCreation + delta.cacheRead;
+    const int toolCalls = record.tools.size();
+
+    auto apply = [&](Totals &t) {
+        t.inputTokens += delta.input;
+        t.outputTokens += delta.output;
+        t.cacheCreationTokens += delta.cacheCreation;
+        t.cacheReadTokens += delta.cacheRead;
+        t.cost += cost.value_or(0);
+        t.unpricedTokens += unpriced;
+        t.toolCalls += toolCalls;
+        if (newMessage)
+            t.messages++;
+    };
+    apply(m_total);
+    apply(m_bySession[groupKey(record.sessionId, "(no session)")]);
+    apply(m_byModel[groupKey(record.model, "(unknown model)")]);
+
+    for (const QString &tool : record.tools)
+        m_byTool[groupKey(tool, "(unnamed)")].toolCalls++;
+}
+
+void JsonlUsageModel::rebuildRows()
+{
+    m_refreshTimer.stop();
+
+    const QHash<QString, Totals> &groups = m_groupBy == QStringLiteral("session") ? m_bySession
+                                         : m_groupBy == QStringLiteral("tool")    ? m_byTool
+                                                                                   : m_byModel;
+    beginResetModel();
+    m_rows.clear();
+    m_rows.reserve(groups.size());
+    for (auto it = groups.cbegin(); it != groups.cend(); ++it)
+        m_rows.append({it.key(), it.value()});
+
+    // Most expensive first; tools have no cost, so they sort by call count
+    std::sort(m_rows.begin(), m_rows.end(), [](const auto &a, const auto &b) {
+        if (a.second.cost != b.second.cost)
+            return a.second.cost > b.second.cost;
+        return a.second.toolCalls > b.second.toolCalls;
+    });
+    endResetModel();
+    emit totalsChanged();
+}
+
+void JsonlUsageModel::reset()
+{
+    cancel();
+    m_generation++;
+    m_bySession.clear();
+    m_byModel.clear();
+    m_byTool.clear();
+    m_messageUsage.clear();
+    m_total = Totals();
+    m_fileCount = 0;
+    rebuildRows();
+}
+
+void JsonlUsageModel::analyzeFolder(const QString &folderPath)
+{
+    QStringList paths;
+    QDirIterator it(folderPath, { QStringLiteral("*.jsonl") }, QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext())
+        paths.append(it.next());
+    analyzeFiles(paths);
+}
+
+void JsonlUsageModel::analyzeFiles(const QStringList &paths)
+{
+    reset();
+
+    auto cancelFlag = std::make_shared<std::atomic<bool>>(false);
+    m_scanCancel = cancelFlag;
+    const quint64 generation = m_generation;
+    m_busy = true;
+    emit busyChanged();
+
+    // Files are scanned concurrently; records reach the model in batches
+    QPointer<JsonlUsageModel> self(this);
+    (void)QtConcurrent::run([self, files = paths, cancelFlag, generation]() mutable {
+        auto post = [self, cancelFlag, generation](QVector<JsonlUsageRecord> &&records) {
+            if (cancelFlag->load() || !self) return;
+            QMetaObject::invokeMethod(self.data(), "onRecordsScanned", Qt::QueuedConnection,
+                                      Q_ARG(QVector<JsonlUsageRecord>, records),
+                                      Q_ARG(quint64, generation));
+        };
+        QtConcurrent::blockingMap(files, [&](const QString &path) {
+            if (!cancelFlag->load())
+                scanFile(path, cancelFlag, post);
+        });
+
+        if (cancelFlag->load() || !self) return;
+        QMetaObject::invokeMethod(self.data(), "onScanFinished", Qt::QueuedConnection,
+                                  Q_ARG(int, int(files.size())), Q_ARG(quint64, generation));
+    });
+}
+
+void JsonlUsageModel::cancel()
+{
+    if (m_scanCancel) {
+        m_scanCancel->store(true);
+        m_scanCancel.reset();
+    }
+    if (m_busy) {
+        m_busy = false;
+        emit busyChanged();
+    }
+}
+
+void JsonlUsageModel::onRecordsScanned(const QVector<JsonlUsageRecord> &records, quint64 generation)
+{
+    if (generation != m_generation) return;
+    addRecords(records);
+}
+
+void JsonlUsageModel::onScanFinished(int fileCount, quint64 generation)
+{
+    if (generation != m_generation) return;
+    m_scanCancel.reset();
+    m_fileCount = fileCount;
+    rebuildRows();
+    m_busy = false;
+    emit busyChanged();
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+#include <QVector>
+#include <QtQml/qqmlregistration.h>
+#include <atomic>
+#include <memory>
+#include <optional>
+
+// Token usage reported on one transcript line (an assistant API message, or
+// one content block of it — Claude Code repeats the usage on each block).
+struct JsonlUsageRecord {
+    QString messageId;
+    QString sessionId;
+    QString model;
+    qint64 inputTokens = 0;
+    qint64 outputTokens = 0;
+    qint64 cacheCreationTokens = 0;
+    qint64 cacheReadTokens = 0;
+    QStringList tools;           // tool_use blocks on this line
+
+    // Fill from a parsed line; false when it carries no usage
+    static bool fromJson(const QJsonObject &obj, JsonlUsageRecord &record);
+};
+
+// Per-group token and cost totals over JSONL transcripts. Grouped by model,
+// session or tool; records stream in from the open transcript's loader or
+// from analyzeFiles(), which scans any number of transcripts on the thread
+// pool without loading them into memory.
+class JsonlUsageModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("Use via AppController")
+
+    Q_PROPERTY(QString groupBy READ groupBy WRITE setGroupBy NOTIFY groupByChanged)
+    Q_PROPERTY(QVariantMap totals READ totals NOTIFY totalsChanged)
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+    Q_PROPERTY(int fileCount READ fileCount NOTIFY totalsChanged)
+
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        InputTokensRole,
+        OutputTokensRole,
+        CacheCreationTokensRole,
+        CacheReadTokensRole,
+        MessagesRole,
+        ToolCallsRole,
+        CostRole,
+        UnpricedTokensRole
+    };
+    Q_ENUM(Roles)
+
+    explicit JsonlUsageModel(QObject *parent = nullptr);
+    ~JsonlUsageModel() override;
+
+    int rowCount(const QModelIndex &parent = {}) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QString groupBy() const;
+    void setGroupBy(const QString &groupBy);   // "model", "session" or "tool"
+    QVariantMap totals() const;
+    bool busy() const;
+    int fileCount() const;
+
+    void addRecords(const QVector<JsonlUsageRecord> &records);
+
+    Q_INVOKABLE void reset();
+    Q_INVOKABLE void analyzeFiles(const QStringList &paths);
+    // All *.jsonl files below a folder
+    Q_INVOKABLE void analyzeFolder(const QString &folderPath);
+    Q_INVOKABLE void cancel();
+
+    // List price in USD for the given token counts; empty for models
+    // without a known price
+    static std::optional<double> costFor(const QString &model, qint64 input, qint64 output,
+                                         qint64 cacheCreation, qint64 cacheRead);
+
+signals:
+    void groupByChanged();
+    void totalsChanged();
+    void busyChanged();
+
+private slots:
+    void onRecordsScanned(const QVector<JsonlUsageRecord> &records, quint64 generation);
+    void onScanFinished(int fileCount, quint64 generation);
+
+private:
+    struct Totals {
+        qint64 inputTokens = 0;
+        qint64 outputTokens = 0;
+        qint64 cacheCreationTokens = 0;
+        qint64 cacheReadTokens = 0;
+        int messages = 0;
+        int toolCalls = 0;
+        double cost = 0;
+        qint64 unpricedTokens = 0;    // from models costFor() has no price for
+    };
+    struct Usage {
+        qint64 input = 0;
+        qint64 output = 0;
+        qint64 cacheCreation = 0;
+        qint64 cacheRead = 0;
+    };
+
+    void addToGroups(const JsonlUsageRecord &record, const Usage &delta, bool newMessage);
+    void rebuildRows();
+
+    QString m_groupBy = QStringLiteral("model");
+    QHash<QString, Totals> m_bySession;
+    QHash<QString, Totals> m_byModel;
+    QHash<QString, Totals> m_byTool;
+    Totals m_total;
+    QHash<QString, Usage> m_messageUsage;   // counted usage per message id (dedupe)
+    QVector<QPair<QString, Totals>> m_rows;
+    QTimer m_refreshTimer;                  // coalesces row rebuilds while streaming
+    int m_fileCount = 0;
+
+    bool m_busy = false;
+    std::shared_ptr<std::atomic<bool>> m_scanCancel;
+    quint64 m_generation = 0;
+};
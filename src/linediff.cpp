@@ -0,0 +1,434 @@
+#include "linediff.h"
+
+#include <QHash>
+#include <QStringView>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int kMinCost = 256;
+constexpr int kMaxWordDiffChars = 20000;   // longer pairs are left as whole lines
+
+using LineDiff::Run;
+using LineDiff::Span;
+
+class Differ
+{
+public:
+    Differ(const QVector<int> &a, const QVector<int> &b, int maxCost)
+        : m_a(a), m_b(b), m_maxCost(maxCost)
+    {
+        const int maxD = (a.size() + b.size() + 1) / 2;
+        m_v1.resize(2 * maxD + 2);
+        m_v2.resize(2 * maxD + 2);
+    }
+
+    QVector<Run> run()
+    {
+        // Explicit stack instead of recursion; boxes are popped left to
+        // right so runs come out in order
+        struct Task { int a0, a1, b0, b1; bool equal; };
+        QVector<Task> stack { { 0, int(m_a.size()), 0, int(m_b.size()), false } };
+
+        while (!stack.isEmpty()) {
+            const Task t = stack.takeLast();
+            if (t.equal) {
+                addEqual(t.a0, t.b0, t.a1 - t.a0);
+                continue;
+            }
+
+            int a0 = t.a0, a1 = t.a1, b0 = t.b0, b1 = t.b1;
+            while (a0 < a1 && b0 < b1 && m_a[a0] == m_b[b0]) {
+                ++a0;
+                ++b0;
+            }
+            addEqual(t.a0, t.b0, a0 - t.a0);
+            while (a1 > a0 && b1 > b0 && m_a[a1 - 1] == m_b[b1 - 1]) {
+                --a1;
+                --b1;
+            }
+            if (a1 < t.a1)
+                stack.append({ a1, t.a1, b1, t.b1, true });
+
+            int x = 0, y = 0;
+            if (a0 == a1 || b0 == b1 || !bisect(a0, a1, b0, b1, x, y)) {
+                addChange(a0, a1 - a0, b0, b1 - b0);
+                continue;
+            }
+            stack.append({ x, a1, y, b1, false });
+            stack.append({ a0, x, b0, y, false });
+        }
+        return std::move(m_runs);
+    }
+
+private:
+    void addEqual(int a0, int b0, int count)
+    {
+        if (count <= 0)
+            return;
+        if (!m_runs.isEmpty() && m_runs.last().equal) {
+            m_runs.last().aCount += count;
+            m_runs.last().bCount += count;
+            return;
+        }
+        m_runs.append({ a0, count, b0, count, true });
+    }
+
+    void addChange(int a0, int aCount, int b0, int bCount)
+    {
+        if (aCount + bCount == 0)
+            return;
+        if (!m_runs.isEmpty() && !m_runs.last().equal) {
+            m_runs.last().aCount += aCount;
+            m_runs.last().bCount += bCount;
+            return;
+        }
+        m_runs.append({ a0, aCount, b0, bCount, false });
+    }
+
+    // Split point of the box (absolute line indices) on a middle snake, or
+    // on the furthest-reaching path once the cost cap is hit. False when
+    // no useful split exists.
+    bool bisect(int a0, int a1, int b0, int b1, int &splitA, int &splitB)
+    {
+        const int n = a1 - a0;
+        const int m = b1 - b0;
+        const int maxD = (n + m + 1) / 2;
+        const int vOffset = maxD;
+        const int delta = n - m;
+        const bool front = (delta % 2 != 0);
+
+        // Only the diagonals the cost cap lets us reach are reset
+        const int reach = std::min(maxD, m_maxCost + 2) + 1;
+        const int lo = std::max(0, vOffset - reach);
+        const int hi = std::min(int(m_v1.size()), vOffset + reach + 1);
+        std::fill(m_v1.begin() + lo, m_v1.begin() + hi, -1);
+        std::fill(m_v2.begin() + lo, m_v2.begin() + hi, -1);
+        m_v1[vOffset + 1] = 0;
+        m_v2[vOffset + 1] = 0;
+        auto isSet = [lo, hi](const QVector<int> &v, int offset) {
+            return offset >= lo && offset < hi && v[offset] != -1;
+        };
+
+        auto split = [&](int x, int y) {
+            if ((x == 0 && y == 0) || (x == n && y == m))
+                return false;
+            splitA = a0 + x;
+            splitB = b0 + y;
+            return true;
+        };
+
+        int k1start = 0, k1end = 0, k2start = 0, k2end = 0;
+        for (int d = 0; d < maxD; ++d) {
+            if (d > m_maxCost)
+                return heuristicSplit(d, n, m, vOffset, k1start, k1end, k2start, k2end, split);
+
+            for (int k1 = -d + k1start; k1 <= d - k1end; k1 += 2) {
+                const int k1Offset = vOffset + k1;
+                int x1 = (k1 == -d || (k1 != d && m_v1[k1Offset - 1] < m_v1[k1Offset + 1]))
+                             ? m_v1[k1Offset + 1]
+                             : m_v1[k1Offset - 1] + 1;
+                int y1 = x1 - k1;
+                while (x1 < n && y1 < m && m_a[a0 + x1] == m_b[b0 + y1]) {
+                    ++x1;
+                    ++y1;
+                }
+                m_v1[k1Offset] = x1;
+                if (x1 > n) {
+                    k1end += 2;
+                } else if (y1 > m) {
+                    k1start += 2;
+                } else if (front) {
+                    const int k2Offset = vOffset + delta - k1;
+                    if (isSet(m_v2, k2Offset) && x1 >= n - m_v2[k2Offset])
+                        return split(x1, y1);
+                }
+            }
+
+            for (int k2 = -d + k2start; k2 <= d - k2end; k2 += 2) {
+                const int k2Offset = vOffset + k2;
+                int x2 = (k2 == -d || (k2 != d && m_v2[k2Offset - 1] < m_v2[k2Offset + 1]))
+                             ? m_v2[k2Offset + 1]
+                             : m_v2[k2Offset - 1] + 1;
+                int y2 = x2 - k2;
+                while (x2 < n && y2 < m && m_a[a1 - 1 - x2] == m_b[b1 - 1 - y2]) {
+                    ++x2;
+                    ++y2;
+                }
+                m_v2[k2Offset] = x2;
+                if (x2 > n) {
+                    k2end += 2;
+                } else if (y2 > m) {
+                    k2start += 2;
+                } else if (!front) {
+                    const int k1Offset = vOffset + delta - k2;
+                    if (isSet(m_v1, k1Offset)) {
+                        const int x1 = m_v1[k1Offset];
+                        const int y1 = vOffset + x1 - k1Offset;
+                        if (x1 >= n - x2)
+                            return split(x1, y1);
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    // Too expensive: split where either search got furthest from its corner
+    template <typename Split>
+    bool heuristicSplit(int d, int n, int m, int vOffset, int k1start, int k1end,
+                        int k2start, int k2end, Split &split)
+    {
+        int bestForward = -1, fx = 0, fy = 0;
+        for (int k = -(d - 1) + k1start; k <= (d - 1) - k1end; k += 2) {
+            const int x = m_v1[vOffset + k];
+            const int y = x - k;
+            if (x <= n && y >= 0 && y <= m && x + y > bestForward) {
+                bestForward = x + y;
+                fx = x;
+                fy = y;
+            }
+        }
+        int bestBackward = -1, bx = 0, by = 0;
+        for (int k = -(d - 1) + k2start; k <= (d - 1) - k2end; k += 2) {
+            const int x = m_v2[vOffset + k];
+            const int y = x - k;
+            if (x <= n && y >= 0 && y <= m && x + y > bestBackward) {
+                bestBackward = x + y;
+                bx = n - x;
+                by = m - y;
+            }
+        }
+        if (bestForward < 0 && bestBackward < 0)
+            return false;
+        return bestForward >= bestBackward ? split(fx, fy) : split(bx, by);
+    }
+
+    const QVector<int> &m_a;
+    const QVector<int> &m_b;
+    const int m_maxCost;
+    QVector<int> m_v1;
+    QVector<int> m_v2;
+    QVector<Run> m_runs;
+};
+
+QVector<Run> diffIds(const QVector<int> &a, const QVector<int> &b, int maxCost)
+{
+    if (maxCost <= 0)
+        maxCost = std::max(kMinCost, int(std::sqrt(double(a.size() + b.size()))));
+    return Differ(a, b, maxCost).run();
+}
+
+// ── Intra-line ───────────────────────────────────────────────
+
+struct Token {
+    int start;
+    int length;
+};
+
+bool isWordChar(QChar c) { return c.isLetterOrNumber() || c == u'_'; }
+
+QVector<Token> tokenize(QStringView line)
+{
+    QVector<Token> tokens;
+    for (int i = 0; i < line.size();) {
+        const QChar c = line[i];
+        int j = i + 1;
+        if (isWordChar(c)) {
+            while (j < line.size() && isWordChar(line[j]))
+                ++j;
+        } else if (c.isSpace()) {
+            while (j < line.size() && line[j].isSpace())
+                ++j;
+        } else if (c.isHighSurrogate() && j < line.size() && line[j].isLowSurrogate()) {
+            ++j;
+        }
+        tokens.append({ i, j - i });
+        i = j;
+    }
+    return tokens;
+}
+
+// Characters covered by `count` tokens from `first`
+Span tokenRange(const QVector<Token> &tokens, int first, int count)
+{
+    if (count == 0)
+        return {};
+    const Token &last = tokens[first + count - 1];
+    return { tokens[first].start, last.start + last.length - tokens[first].start };
+}
+
+void addSpan(QVector<Span> &spans, int start, int length)
+{
+    if (length <= 0)
+        return;
+    if (!spans.isEmpty() && spans.last().start + spans.last().length == start) {
+        spans.last().length += length;
+        return;
+    }
+    spans.append({ start, length });
+}
+
+// Character diff of two words at `a`/`b`. Falls back to marking both words
+// whole when they have less than half their characters in common.
+void refineWord(QStringView line1, Span a, QStringView line2, Span b,
+                QVector<Span> &aSpans, QVector<Span> &bSpans)
+{
+    auto codes = [](QStringView word) {
+        QVector<int> out;
+        out.reserve(word.size());
+        for (QChar c : word)
+            out.append(c.unicode());
+        return out;
+    };
+    const QVector<Run> runs = diffIds(codes(line1.sliced(a.start, a.length)),
+                                      codes(line2.sliced(b.start, b.length)), 0);
+    int common = 0;
+    for (const Run &run : runs) {
+        if (run.equal)
+            common += run.aCount;
+    }
+    if (2 * common < std::max(a.length, b.length)) {
+        addSpan(aSpans, a.start, a.length);
+        addSpan(bSpans, b.start, b.length);
+        return;
+    }
+    for (const Run &run : runs) {
+        if (!run.equal) {
+            addSpan(aSpans, a.start + run.aStart, run.aCount);
+            addSpan(bSpans, b.start + run.bStart, run.bCount);
+        }
+    }
+}
+
+} // namespace
+
+namespace LineDiff {
+
+QVector<Run> diff(const QStringList &a, const QStringList &b, const Options &options)
+{
+    // Intern lines so the search compares integers
+    QHash<QStringView, int> ids;
+    ids.reserve(a.size() + b.size());
+    auto intern = [&ids](const QStringList &lines) {
+        QVector<int> out;
+        out.reserve(lines.size());
+        for (const QString &line : lines) {
+            auto it = ids.constFind(line);
+            if (it == ids.constEnd())
+                it = ids.insert(line, int(ids.size()));
+            out.append(it.value());
+        }
+        return out;
+    };
+    const QVector<int> ia = intern(a);
+    const QVector<int> ib = intern(b);
+
+    return diffIds(ia, ib, options.maxCost);
+}
+
+void wordDiff(QStringView a, QStringView b, QVector<Span> &aSpans, QVector<Span> &bSpans)
+{
+    aSpans.clear();
+    bSpans.clear();
+    if (a.size() + b.size() > kMaxWordDiffChars)
+        return;
+
+    const QVector<Token> ta = tokenize(a);
+    const QVector<Token> tb = tokenize(b);
+    QHash<QStringView, int> ids;
+    ids.reserve(ta.size() + tb.size());
+    auto intern = [&ids](QStringView line, const QVector<Token> &tokens) {
+        QVector<int> out;
+        out.reserve(tokens.size());
+        for (const Token &token : tokens) {
+            const QStringView text = line.sliced(token.start, token.length);
+            auto it = ids.constFind(text);
+            if (it == ids.constEnd())
+                it = ids.insert(text, int(ids.size()));
+            out.append(it.value());
+        }
+        return out;
+    };
+    const QVector<int> ia = intern(a, ta);
+    const QVector<int> ib = intern(b, tb);
+
+    bool shared = false;   // any equal token that isn't whitespace
+    for (const Run &run : diffIds(ia, ib, 0)) {
+        if (run.equal) {
+            for (int i = run.aStart; i < run.aStart + run.aCount && !shared; ++i)
+                shared = !a[ta[i].start].isSpace();
+            continue;
+        }
+        const Span sa = tokenRange(ta, run.aStart, run.aCount);
+        const Span sb = tokenRange(tb, run.bStart, run.bCount);
+        if (run.aCount == 1 && run.bCount == 1
+            && isWordChar(a[sa.start]) && isWordChar(b[sb.start])) {
+            refineWord(a, sa, b, sb, aSpans, bSpans);
+        } else {
+            addSpan(aSpans, sa.start, sa.length);
+            addSpan(bSpans, sb.start, sb.length);
+        }
+    }
+
+    if (!shared) {
+        aSpans.clear();
+        bSpans.clear();
+    }
+}
+
+QVector<Hunk> hunks(const QVector<Run> &runs, int contextLines)
+{
+    QVector<Hunk> out;
+    if (contextLines < 0) {
+        if (!runs.isEmpty())
+            out.append({ 0, 0, 0, 0, runs });
+    } else {
+        Hunk current;
+        bool open = false;
+        for (int i = 0; i < runs.size(); ++i) {
+            const Run &run = runs[i];
+            if (!run.equal) {
+                if (!open) {
+                    current = Hunk();
+                    if (i > 0 && contextLines > 0) {
+                        // Trailing context from the unchanged run before
+                        const Run &prev = runs[i - 1];
+                        const int take = std::min(contextLines, prev.aCount);
+                        current.runs.append({ prev.aStart + prev.aCount - take, take,
+                                              prev.bStart + prev.bCount - take, take, true });
+                    }
+                    open = true;
+                }
+                current.runs.append(run);
+                continue;
+            }
+            if (!open)
+                continue;
+            if (i + 1 < runs.size() && run.aCount <= 2 * contextLines) {
+                current.runs.append(run);   // short gap — keep the hunk going
+                continue;
+            }
+            const int take = std::min(contextLines, run.aCount);
+            if (take > 0)
+                current.runs.append({ run.aStart, take, run.bStart, take, true });
+            out.append(current);
+            open = false;
+        }
+        if (open)
+            out.append(current);
+    }
+
+    for (Hunk &hunk : out) {
+        hunk.aStart = hunk.runs.first().aStart;
+        hunk.bStart = hunk.runs.first().bStart;
+        for (const Run &run : hunk.runs) {
+            hunk.aCount += run.aCount;
+            hunk.bCount += run.bCount;
+        }
+    }
+    return out;
+}
+
+} // namespace LineDiff
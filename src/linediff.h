@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+
+// Line-level Myers diff in linear space. Lines are interned to integers,
+// common prefixes and suffixes are trimmed, and the remaining box is split
+// at middle snakes (Hirschberg-style) using two V arrays sized to the input
+// — no per-d trace is kept. When a box costs more than `maxCost` edits the
+// split falls back to the furthest-reaching path, trading minimality for
+// bounded time.
+namespace LineDiff {
+
+struct Options {
+    int contextLines = 3;   // unchanged lines kept around each change; -1 keeps all
+    int maxCost = 0;        // edits explored per split before the heuristic; 0 = automatic
+};
+
+// A stretch of lines: equal on both sides, or a change replacing aCount
+// lines of A with bCount lines of B (deletions and insertions grouped)
+struct Run {
+    int aStart = 0;
+    int aCount = 0;
+    int bStart = 0;
+    int bCount = 0;
+    bool equal = false;
+};
+
+// Runs covering both inputs in order
+QVector<Run> diff(const QStringList &a, const QStringList &b, const Options &options = {});
+
+// Changes with up to `contextLines` of surrounding unchanged lines. Longer
+// unchanged stretches between hunks are left out.
+struct Hunk {
+    int aStart = 0;
+    int aCount = 0;
+    int bStart = 0;
+    int bCount = 0;
+    QVector<Run> runs;      // clipped to the hunk
+};
+
+QVector<Hunk> hunks(const QVector<Run> &runs, int contextLines);
+
+// Changed characters within one line
+struct Span {
+    int start = 0;
+    int length = 0;
+};
+
+// Refines a removed/added line pair. Words, whitespace runs and single
+// punctuation marks are interned to integers and diffed; a word replaced by
+// a similar word is narrowed down to characters. Both span lists are empty
+// when the lines share nothing but whitespace, i.e. the whole line changed.
+void wordDiff(QStringView a, QStringView b, QVector<Span> &aSpans, QVector<Span> &bSpans);
+
+} // namespace LineDiff
@@ -0,0 +1,119 @@
+#include "mappedfile.h"
+
+#ifndef Q_OS_WIN
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const QString &filePath)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    m_size = m_file.size();
+    if (m_size == 0)
+        return true;
+
+    m_map = m_file.map(0, m_size);
+    if (m_map) {
+        m_data = reinterpret_cast<const char *>(m_map);
+        return true;
+    }
+
+    // Mapping can fail on some filesystems (network shares, pipes) — read instead
+    m_buffer = m_file.readAll();
+    m_size = m_buffer.size();
+    m_data = m_buffer.constData();
+    return true;
+}
+
+bool MappedFile::remap()
+{
+    if (!m_file.isOpen())
+        return false;
+
+    const qint64 newSize = m_file.size();
+    if (newSize == m_size)
+        return true;
+
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_buffer.clear();
+
+    if (newSize == 0)
+        return true;
+
+    m_map = m_file.map(0, newSize);
+    if (m_map) {
+        m_data = reinterpret_cast<const char *>(m_map);
+        m_size = newSize;
+        return true;
+    }
+
+    m_file.seek(0);
+    m_buffer = m_file.readAll();
+    m_size = m_buffer.size();
+    m_data = m_buffer.constData();
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    if (m_file.isOpen())
+        m_file.close();
+    m_buffer.clear();
+    m_data = nullptr;
+    m_size = 0;
+}
+
+QByteArray MappedFile::bytes(qint64 offset, qint64 length) const
+{
+    if (!m_data || offset < 0 || offset >= m_size || length <= 0)
+        return {};
+    length = qMin(length, m_size - offset);
+    return QByteArray::fromRawData(m_data + offset, length);
+}
+
+QByteArray MappedFile::read(qint64 offset, qint64 length) const
+{
+    if (!m_file.isOpen() || offset < 0 || length <= 0)
+        return {};
+
+    // Windows refuses to truncate a file while it is mapped, and the
+    // fallback buffer is a private copy, so both can be read in place
+#ifndef Q_OS_WIN
+    if (m_map) {
+        QByteArray result(length, Qt::Uninitialized);
+        qint64 done = 0;
+        while (done < length) {
+            const ssize_t n = ::pread(m_file.handle(), result.data() + done,
+                                      size_t(length - done), off_t(offset + done));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            done += n;
+        }
+        result.truncate(done);
+        return result;
+    }
+#endif
+    const QByteArray view = bytes(offset, length);
+    return QByteArray(view.constData(), view.size());
+}
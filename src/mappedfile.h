@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+// Read-only view of a file's bytes. Memory-maps the file when the platform
+// allows it and falls back to reading it into memory otherwise.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const QString &filePath);
+    void close();
+
+    // Refresh the view after the file grew on disk (e.g. an appended log).
+    // Invalidates previously returned data() pointers and bytes() slices.
+    bool remap();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    QString filePath() const { return m_file.fileName(); }
+    const char *data() const { return m_data; }
+    qint64 size() const { return m_size; }
+
+    // Raw (non-owning) slice of the view; clamped to the mapped range.
+    // Only valid while the file stays open.
+    QByteArray bytes(qint64 offset, qint64 length) const;
+
+    // Owned copy of a range, read from the file rather than the mapping.
+    // Safe when the file may have been truncated behind the view: touching a
+    // mapped page past the new end of file raises SIGBUS. Returns fewer bytes
+    // (or none) if the range no longer exists on disk.
+    QByteArray read(qint64 offset, qint64 length) const;
+
+private:
+    QFile m_file;
+    uchar *m_map = nullptr;
+    QByteArray m_buffer;     // fallback when mapping is not possible
+    const char *m_data = nullptr;
+    qint64 m_size = 0;
+};
@@ -0,0 +1,114 @@
+#include "merge3.h"
+#include "linediff.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+// A changed base range [aStart, aEnd) and what one side has there instead
+struct Change {
+    int aStart;
+    int aEnd;
+    int bStart;
+    int bEnd;
+};
+
+// One side's changes, consumed in base order
+struct Side {
+    QVector<Change> changes;
+    int next = 0;    // first change not merged yet
+    int delta = 0;   // side line minus base line, outside changes
+};
+
+QStringList splitLines(QString text)
+{
+    text.remove(QLatin1Char('\r'));
+    return text.split(QLatin1Char('\n'));
+}
+
+QVector<Change> changesAgainst(const QStringList &base, const QStringList &side)
+{
+    QVector<Change> out;
+    for (const LineDiff::Run &run : LineDiff::diff(base, side)) {
+        if (!run.equal)
+            out.append({ run.aStart, run.aStart + run.aCount,
+                         run.bStart, run.bStart + run.bCount });
+    }
+    return out;
+}
+
+// Lines a side has for base range [r0, r1), given its changes [first, side.next)
+// inside the range
+QStringList sideLines(Side &side, int first, const QStringList &lines, int r0, int r1)
+{
+    if (first == side.next)
+        return lines.mid(r0 + side.delta, r1 - r0);
+    const Change &head = side.changes[first];
+    const Change &tail = side.changes[side.next - 1];
+    const int start = head.bStart - (head.aStart - r0);
+    const int end = tail.bEnd + (r1 - tail.aEnd);
+    side.delta = end - r1;
+    return lines.mid(start, end - start);
+}
+
+} // namespace
+
+namespace Merge3 {
+
+Result merge(const QString &base, const QString &ours, const QString &theirs)
+{
+    const QStringList b = splitLines(base);
+    const QStringList o = splitLines(ours);
+    const QStringList t = splitLines(theirs);
+    Side sideO { changesAgainst(b, o) };
+    Side sideT { changesAgainst(b, t) };
+
+    Result result;
+    QStringList merged;
+    int pos = 0;   // base lines before this are already in `merged`
+    while (sideO.next < sideO.changes.size() || sideT.next < sideT.changes.size()) {
+        // A region starts at the earliest pending change and absorbs every
+        // change from either side that overlaps or touches it
+        int r0 = INT_MAX;
+        for (const Side *side : { &sideO, &sideT }) {
+            if (side->next < side->changes.size())
+                r0 = std::min(r0, side->changes[side->next].aStart);
+        }
+        int r1 = r0;
+        const int firstO = sideO.next;
+        const int firstT = sideT.next;
+        for (bool grew = true; grew;) {
+            grew = false;
+            for (Side *side : { &sideO, &sideT }) {
+                while (side->next < side->changes.size()
+                       && side->changes[side->next].aStart <= r1) {
+                    r1 = std::max(r1, side->changes[side->next].aEnd);
+                    ++side->next;
+                    grew = true;
+                }
+            }
+        }
+
+        merged += b.mid(pos, r0 - pos);
+        const bool changedO = sideO.next > firstO;
+        const bool changedT = sideT.next > firstT;
+        const QStringList linesO = sideLines(sideO, firstO, o, r0, r1);
+        const QStringList linesT = sideLines(sideT, firstT, t, r0, r1);
+        if (!changedT) {
+            merged += linesO;
+        } else if (!changedO || linesO == linesT) {
+            merged += linesT;
+        } else {
+            result.conflicts.append({ r0, b.mid(r0, r1 - r0), linesO, linesT });
+            merged += linesO;
+        }
+        pos = r1;
+    }
+    merged += b.mid(pos);
+
+    result.merged = merged.join(QLatin1Char('\n'));
+    return result;
+}
+
+} // namespace Merge3
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Line-based three-way merge on top of LineDiff. Both sides are diffed
+// against the common base; changes to separate base ranges are combined,
+// and a range both sides changed in different ways is a conflict. Changes
+// that touch or abut each other count as the same range.
+namespace Merge3 {
+
+struct Conflict {
+    int baseLine = 0;          // first base line of the range, 0-based
+    QStringList base;
+    QStringList ours;
+    QStringList theirs;
+};
+
+struct Result {
+    QString merged;                // conflicting ranges keep `ours`
+    QVector<Conflict> conflicts;   // empty for a clean merge
+};
+
+// Line endings are normalized to LF
+Result merge(const QString &base, const QString &ours, const QString &theirs);
+
+} // namespace Merge3
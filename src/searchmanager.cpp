@@ -2,19 +2,232 @@
 
 #include "projecttreemodel.h"
 #include "configmanager.h"
+#include "mappedfile.h"
+#include "searchquery.h"
+#include "workspaceindex.h"
 
-#include <QFile>
-#include <QTextStream>
+#include <QElapsedTimer>
+#include <QMutex>
 #include <QPointer>
+#include <QSet>
+#include <QStringDecoder>
 #include <QtConcurrent>
+#include <algorithm>
 #include <functional>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr int kBatchHits = 200;              // hits per batch sent to the UI...
+constexpr qint64 kBatchIntervalMs = 30;      // ...or whatever is pending after this long
+constexpr int kContextChars = 100;           // kept before a match in long lines
+constexpr int kMaxHitText = 300;
+constexpr int kMaxFuzzyResults = 20;
+constexpr qsizetype kDecodeChunk = 1 << 20;   // bytes decoded per window for expressions
+
+struct Hit {
+    int line;
+    QString text;
+};
+
+struct LineMatch {
+    int line;
+    qsizetype lineStart;
+    qsizetype lineEnd;
+    qsizetype pos;              // where the match starts
+};
+
+QByteArrayView view(const QByteArray &bytes) { return bytes; }
+QStringView view(const QString &text) { return text; }
+
+// Lines of `text` (bytes or decoded) holding a match of `pattern`, in
+// order, at most `limit` of them
+template <typename Text>
+QVector<LineMatch> matchLines(const Text &text, const SearchQuery::Pattern &pattern, int limit,
+                              const std::atomic<bool> &stop)
+{
+    using Char = typename Text::value_type;
+    const Char newline = Char('\n');
+    QVector<LineMatch> lines;
+    int line = 1;
+    qsizetype counted = 0;   // newlines before this offset are in `line`
+    for (qsizetype pos = pattern.indexIn(view(text), 0);
+         pos >= 0 && lines.size() < limit && !stop.load();) {
+        line += int(std::count(text.cbegin() + counted, text.cbegin() + pos, newline));
+        counted = pos;
+        const qsizetype lineStart = pos > 0 ? text.lastIndexOf(newline, pos - 1) + 1 : 0;
+        qsizetype lineEnd = text.indexOf(newline, pos);
+        if (lineEnd < 0)
+            lineEnd = text.size();
+        lines.append({ line, lineStart, lineEnd, pos });
+        pos = lineEnd < text.size() ? pattern.indexIn(view(text), lineEnd + 1) : -1;
+    }
+    return lines;
+}
+
+// Lines of `a` with a line of `b` at most `distance` lines away
+QVector<LineMatch> nearLines(const QVector<LineMatch> &a, const QVector<LineMatch> &b,
+                             int distance, int limit)
+{
+    QVector<LineMatch> lines;
+    qsizetype j = 0;
+    for (const LineMatch &match : a) {
+        while (j < b.size() && b[j].line < match.line - distance)
+            ++j;
+        if (j < b.size() && b[j].line <= match.line + distance) {
+            lines.append(match);
+            if (lines.size() >= limit)
+                break;
+        }
+    }
+    return lines;
+}
+
+// Runs `query` over `text` and turns each matching line into a Hit.
+// `decode(from, to)` gives the text of a range.
+template <typename Text, typename Decode>
+QVector<Hit> collectHits(const Text &text, const SearchQuery &query, Decode decode, int maxHits,
+                         const std::atomic<bool> &stop)
+{
+    QVector<LineMatch> lines;
+    if (const SearchQuery::Pattern *near = query.nearPattern()) {
+        const int all = std::numeric_limits<int>::max();
+        lines = nearLines(matchLines(text, query.pattern(), all, stop),
+                          matchLines(text, *near, all, stop), query.nearDistance(), maxHits);
+    } else {
+        lines = matchLines(text, query.pattern(), maxHits, stop);
+    }
+
+    QVector<Hit> hits;
+    hits.reserve(lines.size());
+    for (const LineMatch &match : std::as_const(lines)) {
+        // Long lines (minified JSON, JSONL) are cut down to the match
+        QString lineText = decode(match.lineStart, match.lineEnd);
+        if (lineText.size() > kMaxHitText) {
+            const qsizetype column = decode(match.lineStart, match.pos).size();
+            lineText = lineText.mid(std::max<qsizetype>(0, column - kContextChars), kMaxHitText);
+        }
+        hits.append({ match.line, lineText.trimmed() });
+    }
+    return hits;
+}
+
+// Decodes `bytes` in line-aligned windows of about kDecodeChunk bytes and
+// searches each, so a huge file never exists as one QString. With NEAR,
+// each window also carries the last nearDistance() lines of the previous
+// one, and a line found again there is reported once.
+QVector<Hit> searchDecoded(QByteArrayView bytes, QStringConverter::Encoding encoding,
+                           const SearchQuery &query, int maxHits, const std::atomic<bool> &stop)
+{
+    const int context = query.nearPattern() ? query.nearDistance() : 0;
+    QStringDecoder decoder(encoding);
+    QVector<Hit> hits;
+    QSet<int> reported;
+    QString pending;          // decoded text not yet searched, from a line start
+    int pendingLine = 1;      // line number of pending's first line
+    qsizetype contextSize = 0;   // leading part of pending searched before
+
+    for (qsizetype offset = 0; offset < bytes.size() && hits.size() < maxHits && !stop.load();) {
+        const qsizetype chunk = std::min<qsizetype>(kDecodeChunk, bytes.size() - offset);
+        pending += decoder(bytes.sliced(offset, chunk));
+        offset += chunk;
+        const qsizetype end = offset == bytes.size() ? pending.size()
+                                                     : pending.lastIndexOf(u'\n') + 1;
+        if (end <= contextSize)
+            continue;   // no complete new line yet
+
+        const QString window = pending.first(end);
+        const int limit = maxHits - int(hits.size()) + int(reported.size());
+        const QVector<Hit> found = collectHits(
+            window, query,
+            [&window](qsizetype from, qsizetype to) { return window.mid(from, to - from); },
+            limit, stop);
+        for (const Hit &hit : found) {
+            const int line = pendingLine + hit.line - 1;
+            if (hits.size() < maxHits && (context == 0 || !reported.contains(line))) {
+                hits.append({ line, hit.text });
+                if (context > 0)
+                    reported.insert(line);
+            }
+        }
+
+        // Keep the window's last `context` lines in front of the next one
+        qsizetype keep = end;
+        for (int i = 0; i < context && keep > 0; ++i) {
+            const qsizetype nl = keep > 1 ? window.lastIndexOf(u'\n', keep - 2) : -1;
+            keep = nl + 1;
+            if (nl < 0)
+                break;
+        }
+        pendingLine += int(std::count(window.cbegin(), window.cbegin() + keep, u'\n'));
+        pending.remove(0, keep);
+        contextSize = end - keep;
+    }
+
+    if (context > 0)
+        std::sort(hits.begin(), hits.end(), [](const Hit &a, const Hit &b) { return a.line < b.line; });
+    return hits;
+}
+
+QVector<Hit> searchFile(const QString &filePath, const SearchQuery &query, int maxHits,
+                        const std::atomic<bool> &stop)
+{
+    // Mapped, not read: pool threads search many files at once, some of
+    // them multi-gigabyte transcripts
+    MappedFile file;
+    if (!file.open(filePath))
+        return {};
+    const QByteArray bytes = file.bytes(0, file.size());
+    const auto bomEncoding = QStringConverter::encodingForData(bytes);
+    const bool utf8 = !bomEncoding || *bomEncoding == QStringConverter::Utf8;
+
+    const SearchQuery::Pattern *near = query.nearPattern();
+    if (utf8) {
+        // Literals every match needs rule the file out before any expression runs
+        if (!query.pattern().mayMatch(bytes) || (near && !near->mayMatch(bytes)))
+            return {};
+
+        // Fast path: match the raw UTF-8 and decode only the matching lines
+        if (query.pattern().matchesUtf8() && (!near || near->matchesUtf8())) {
+            return collectHits(
+                bytes, query,
+                [&](qsizetype from, qsizetype to) {
+                    return QString::fromUtf8(bytes.constData() + from, to - from);
+                },
+                maxHits, stop);
+        }
+    }
+
+    // Regular expression or UTF-16/32 file: decode window by window
+    return searchDecoded(bytes, bomEncoding.value_or(QStringConverter::Utf8), query, maxHits,
+                         stop);
+}
+
+} // namespace
 
 SearchManager::SearchManager(ProjectTreeModel *tree, ConfigManager *config,
-                             QObject *parent)
+                             const QString &indexDir, QObject *parent)
     : QObject(parent)
     , m_projectTreeModel(tree)
     , m_configManager(config)
+    , m_index(new WorkspaceIndex(indexDir, this))
 {
+    // The quick-switcher path table follows the tree
+    auto invalidate = [this]() { m_fileTableStale = true; };
+    connect(tree, &QAbstractItemModel::modelReset, this, invalidate);
+    connect(tree, &QAbstractItemModel::rowsInserted, this, invalidate);
+    connect(tree, &QAbstractItemModel::rowsRemoved, this, invalidate);
+    connect(tree, &QAbstractItemModel::rowsMoved, this, invalidate);
+    connect(tree, &QAbstractItemModel::dataChanged, this, invalidate);
+
+    // The index follows the file types search covers
+    for (auto signal : { &ConfigManager::searchIncludeMarkdownChanged,
+                         &ConfigManager::searchIncludeJsonChanged,
+                         &ConfigManager::searchIncludeYamlChanged,
+                         &ConfigManager::searchIncludeJsonlChanged,
+                         &ConfigManager::searchIncludePlaintextChanged })
+        connect(m_configManager, signal, this, &SearchManager::syncIndex);
 }
 
 QStringList SearchManager::getAllFiles() const
@@ -33,30 +246,61 @@ QStringList SearchManager::getAllFiles() const
     return files;
 }
 
-static int fuzzyScore(const QString &query, const QString &text)
+// Both arguments lowercase
+static int fuzzyScore(QStringView query, QStringView text)
 {
-    const QString lq = query.toLower();
-    const QString lt = text.toLower();
-
     // Exact substring match gets highest base score
-    int subIdx = lt.indexOf(lq);
+    const qsizetype subIdx = text.indexOf(query);
     if (subIdx >= 0)
-        return 1000 - subIdx;
+        return std::max(0, 1000 - int(subIdx));
 
     // Character-by-character: all query chars must appear in order
     int score = 0;
-    int qi = 0;
-    int lastMatchIdx = -1;
-    for (int ti = 0; ti < lt.length() && qi < lq.length(); ti++) {
-        if (lt[ti] == lq[qi]) {
+    qsizetype qi = 0;
+    qsizetype lastMatchIdx = -1;
+    for (qsizetype ti = 0; ti < text.length() && qi < query.length(); ti++) {
+        if (text[ti] == query[qi]) {
             score += 10;
             if (lastMatchIdx == ti - 1) score += 5;  // consecutive bonus
-            if (ti == 0 || lt[ti - 1] == '/' || lt[ti - 1] == '\\') score += 8;  // word boundary
+            if (ti == 0 || text[ti - 1] == '/' || text[ti - 1] == '\\') score += 8;  // word boundary
             lastMatchIdx = ti;
             qi++;
         }
     }
-    return qi == lq.length() ? score : -1;
+    return qi == query.length() ? score : -1;
+}
+
+// One bit per UTF-16 unit modulo 64. Text can only contain a query whose
+// bits it covers.
+static quint64 charMask(QStringView text)
+{
+    quint64 mask = 0;
+    for (QChar c : text)
+        mask |= quint64(1) << (c.unicode() & 63);
+    return mask;
+}
+
+void SearchManager::rebuildFileTable() const
+{
+    const QStringList allFiles = getAllFiles();
+    m_fileTable.clear();
+    m_fileTable.reserve(allFiles.size());
+    for (const QString &fp : allFiles) {
+        FileEntry entry;
+        entry.filePath = fp;
+        const QString normalized = QString(fp).replace('\\', '/');
+        const qsizetype lastSep = normalized.lastIndexOf('/');
+        entry.fileName = normalized.mid(lastSep + 1);
+        entry.dirPath = normalized.left(lastSep);
+        entry.lowerName = entry.fileName.toLower();
+        entry.lowerPath = normalized.toLower();
+        entry.nameMask = charMask(entry.lowerName);
+        entry.pathMask = charMask(entry.lowerPath);
+        m_fileTable.append(entry);
+    }
+    m_fileTableStale = false;
+    m_lastFuzzyQuery.clear();
+    m_lastFuzzyMatches.clear();
 }
 
 QVariantList SearchManager::fuzzyFilterFiles(const QString &query) const
@@ -82,124 +326,236 @@ QVariantList SearchManager::fuzzyFilterFiles(const QString &query) const
         return results;
     }
 
-    // Fuzzy filter all files
-    const QStringList allFiles = getAllFiles();
-    struct ScoredEntry { QString filePath; QString fileName; QString dirPath; int score; };
-    QVector<ScoredEntry> scored;
+    if (m_fileTableStale)
+        rebuildFileTable();
+    const QString lq = trimmed.toLower();
+    const quint64 queryMask = charMask(lq);
 
-    for (const QString &fp : allFiles) {
-        QString normalized = QString(fp).replace('\\', '/');
-        int lastSep = normalized.lastIndexOf('/');
-        QString fileName = normalized.mid(lastSep + 1);
-        int s = fuzzyScore(trimmed, fileName);
+    // Keep the best kMaxFuzzyResults in a heap with the worst on top;
+    // ties go to the earlier file
+    struct Scored { int index; int score; };
+    auto better = [](const Scored &a, const Scored &b) {
+        return a.score != b.score ? a.score > b.score : a.index < b.index;
+    };
+    std::vector<Scored> top;
+    top.reserve(kMaxFuzzyResults + 1);
+    QVector<int> matches;
+
+    auto consider = [&](int i) {
+        const FileEntry &entry = m_fileTable[i];
+        if (queryMask & ~entry.pathMask)
+            return;
+        int s = (queryMask & ~entry.nameMask) ? -1 : fuzzyScore(lq, entry.lowerName);
         if (s < 0) {
-            s = fuzzyScore(trimmed, normalized);
+            s = fuzzyScore(lq, entry.lowerPath);
             if (s >= 0) s = qMax(0, s - 100);
         }
-        if (s >= 0) {
-            scored.append({fp, fileName, normalized.left(lastSep), s});
+        if (s < 0)
+            return;
+        matches.append(i);
+        const Scored candidate{ i, s };
+        if (top.size() < size_t(kMaxFuzzyResults) || better(candidate, top.front())) {
+            top.push_back(candidate);
+            std::push_heap(top.begin(), top.end(), better);
+            if (top.size() > size_t(kMaxFuzzyResults)) {
+                std::pop_heap(top.begin(), top.end(), better);
+                top.pop_back();
+            }
         }
-    }
+    };
 
-    std::sort(scored.begin(), scored.end(), [](const ScoredEntry &a, const ScoredEntry &b) {
-        return a.score > b.score;
-    });
+    // Typing on only drops matches: a path holding the longer query's
+    // characters in order holds the shorter one's too
+    if (!m_lastFuzzyQuery.isEmpty() && lq.startsWith(m_lastFuzzyQuery)) {
+        for (int i : std::as_const(m_lastFuzzyMatches))
+            consider(i);
+    } else {
+        for (int i = 0; i < m_fileTable.size(); i++)
+            consider(i);
+    }
+    m_lastFuzzyQuery = lq;
+    m_lastFuzzyMatches = std::move(matches);
 
-    int limit = qMin(scored.size(), 20);
-    for (int i = 0; i < limit; i++) {
-        QVariantMap entry;
-        entry[QStringLiteral("filePath")] = scored[i].filePath;
-        entry[QStringLiteral("fileName")] = scored[i].fileName;
-        entry[QStringLiteral("dirPath")] = scored[i].dirPath;
-        entry[QStringLiteral("score")] = scored[i].score;
-        entry[QStringLiteral("isRecent")] = false;
-        results.append(entry);
+    std::sort(top.begin(), top.end(), better);
+    for (const Scored &scored : top) {
+        const FileEntry &entry = m_fileTable[scored.index];
+        QVariantMap result;
+        result[QStringLiteral("filePath")] = entry.filePath;
+        result[QStringLiteral("fileName")] = entry.fileName;
+        result[QStringLiteral("dirPath")] = entry.dirPath;
+        result[QStringLiteral("score")] = scored.score;
+        result[QStringLiteral("isRecent")] = false;
+        results.append(result);
     }
     return results;
 }
 
-void SearchManager::searchFiles(const QString &query)
+bool SearchManager::includeInSearch(const QString &path) const
+{
+    if (path.endsWith(QStringLiteral(".jsonl"), Qt::CaseInsensitive))
+        return m_configManager->searchIncludeJsonl();
+    if (path.endsWith(QStringLiteral(".json"), Qt::CaseInsensitive))
+        return m_configManager->searchIncludeJson();
+    if (path.endsWith(QStringLiteral(".yaml"), Qt::CaseInsensitive)
+        || path.endsWith(QStringLiteral(".yml"), Qt::CaseInsensitive))
+        return m_configManager->searchIncludeYaml();
+    if (path.endsWith(QStringLiteral(".md"), Qt::CaseInsensitive)
+        || path.endsWith(QStringLiteral(".markdown"), Qt::CaseInsensitive))
+        return m_configManager->searchIncludeMarkdown();
+    if (path.endsWith(QStringLiteral(".txt"), Qt::CaseInsensitive))
+        return m_configManager->searchIncludePlaintext();
+    if (path.endsWith(QStringLiteral(".pdf"), Qt::CaseInsensitive))
+        return m_configManager->searchIncludePdf();
+    if (path.endsWith(QStringLiteral(".docx"), Qt::CaseInsensitive))
+        return m_configManager->searchIncludeDocx();
+    return false;
+}
+
+void SearchManager::syncIndex()
+{
+    // PDF and DOCX are binary containers; they are always read at search time
+    QStringList files;
+    const QStringList allFiles = getAllFiles();
+    for (const QString &path : allFiles) {
+        if (includeInSearch(path) && !path.endsWith(QStringLiteral(".pdf"), Qt::CaseInsensitive)
+            && !path.endsWith(QStringLiteral(".docx"), Qt::CaseInsensitive))
+            files.append(path);
+    }
+    m_index->sync(files);
+}
+
+void SearchManager::refreshIndexedFile(const QString &filePath)
+{
+    m_index->refresh(filePath);
+}
+
+void SearchManager::searchFiles(const QString &text, bool caseSensitive, bool wholeWord,
+                                bool regex)
 {
     // Cancel any previous search
     if (m_searchCancel)
         m_searchCancel->store(true);
+    const quint64 generation = ++m_searchGeneration;
 
-    if (query.length() < 2) {
-        emit searchResultsReady({});
+    if (text.length() < 2) {
+        emit searchFinished(false);
         return;
     }
 
-    // Gather file list on main thread (fast — just tree walk)
-    auto includeInSearch = [this](const QString &path) {
-        if (path.endsWith(QStringLiteral(".jsonl"), Qt::CaseInsensitive))
-            return m_configManager->searchIncludeJsonl();
-        if (path.endsWith(QStringLiteral(".json"), Qt::CaseInsensitive))
-            return m_configManager->searchIncludeJson();
-        if (path.endsWith(QStringLiteral(".yaml"), Qt::CaseInsensitive)
-            || path.endsWith(QStringLiteral(".yml"), Qt::CaseInsensitive))
-            return m_configManager->searchIncludeYaml();
-        if (path.endsWith(QStringLiteral(".md"), Qt::CaseInsensitive)
-            || path.endsWith(QStringLiteral(".markdown"), Qt::CaseInsensitive))
-            return m_configManager->searchIncludeMarkdown();
-        if (path.endsWith(QStringLiteral(".txt"), Qt::CaseInsensitive))
-            return m_configManager->searchIncludePlaintext();
-        if (path.endsWith(QStringLiteral(".pdf"), Qt::CaseInsensitive))
-            return m_configManager->searchIncludePdf();
-        if (path.endsWith(QStringLiteral(".docx"), Qt::CaseInsensitive))
-            return m_configManager->searchIncludeDocx();
-        return false;
-    };
+    // Compile once; the workers share the result
+    QString error;
+    const std::optional<SearchQuery> parsed =
+        SearchQuery::parse(text, { caseSensitive, wholeWord, regex }, &error);
+    if (!parsed) {
+        emit searchError(error);
+        emit searchFinished(false);
+        return;
+    }
+    const SearchQuery query = *parsed;
 
+    // Gather file list on main thread (fast — just tree walk). Globs see the
+    // path inside its project, so `path:docs/*.md` cannot match a docs/
+    // directory somewhere above the project on disk.
     QStringList files;
-    const QStringList allFiles = getAllFiles();
-    for (const QString &path : allFiles) {
-        if (includeInSearch(path))
-            files.append(path);
+    QString projectPrefix;
+    std::function<void(TreeNode*)> collect = [&](TreeNode *node) {
+        if (node->nodeType() == TreeNode::FileNode) {
+            const QString path = node->path();
+            const QStringView relative = path.startsWith(projectPrefix)
+                ? QStringView(path).mid(projectPrefix.size()) : QStringView(path);
+            if (includeInSearch(path) && query.includesPath(relative.toString()))
+                files.append(path);
+            return;
+        }
+        for (int i = 0; i < node->childCount(); i++)
+            collect(node->child(i));
+    };
+    if (TreeNode *root = m_projectTreeModel->rootNode()) {
+        for (int i = 0; i < root->childCount(); i++) {
+            TreeNode *project = root->child(i);
+            projectPrefix = project->path() + u'/';
+            collect(project);
+        }
     }
 
     if (files.isEmpty()) {
-        emit searchResultsReady({});
+        emit searchFinished(false);
         return;
     }
 
     // Shared cancel flag for this search run
     auto cancel = std::make_shared<std::atomic<bool>>(false);
     m_searchCancel = cancel;
+    const int maxResults = m_configManager->searchMaxResults();
+    const int maxHitsPerFile = m_configManager->searchMaxHitsPerFile();
 
-    // Run file I/O + search on a worker thread
+    // Narrow to the files the index allows, then search them in parallel
+    // on the pool, streaming hits back in batches
+    const std::shared_ptr<const WorkspaceIndex::Snapshot> index = m_index->snapshot();
+    const QSet<QString> unverified = index ? m_index->unverifiedFiles() : QSet<QString>();
     QPointer<SearchManager> self(this);
-    (void)QtConcurrent::run([self, query, files, cancel]() {
-        QVariantList results;
-
-        for (const QString &filePath : files) {
-            if (cancel->load()) return;
-
-            QFile file(filePath);
-            if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-                continue;
-
-            QTextStream in(&file);
-            int lineNum = 0;
-            while (!in.atEnd()) {
-                if (cancel->load()) return;
-                const QString line = in.readLine();
-                lineNum++;
-
-                if (line.indexOf(query, 0, Qt::CaseInsensitive) < 0)
-                    continue;
-
-                QVariantMap hit;
-                hit["filePath"] = filePath;
-                hit["line"] = lineNum;
-                hit["text"] = line.trimmed();
-                results.append(hit);
-            }
-        }
+    (void)QtConcurrent::run([self, generation, query, files, index, unverified, cancel,
+                             maxResults, maxHitsPerFile]() {
+        const QStringList candidates =
+            index ? index->candidates(files, query.requiredLiterals(), unverified) : files;
+
+        auto send = [&self, generation](const QVariantList &batch) {
+            QMetaObject::invokeMethod(self, [self, generation, batch]() {
+                if (self && self->m_searchGeneration == generation)
+                    emit self->searchResultsBatch(batch);
+            }, Qt::QueuedConnection);
+        };
 
-        if (cancel->load() || !self) return;
+        // Shared by the workers below
+        QMutex mutex;
+        QVariantList pending;
+        QElapsedTimer sinceSend;
+        sinceSend.start();
+        int found = 0;
+        std::atomic<bool> stop(false);      // cancelled or result cap reached
+        std::atomic<bool> hasPending(false);
 
-        QMetaObject::invokeMethod(self.data(), "searchResultsReady",
-                                  Qt::QueuedConnection,
-                                  Q_ARG(QVariantList, results));
+        QtConcurrent::blockingMap(candidates, [&](const QString &filePath) {
+            if (cancel->load())
+                stop.store(true);
+            if (stop.load())
+                return;
+
+            const QVector<Hit> hits = searchFile(filePath, query, maxHitsPerFile, stop);
+            if (hits.isEmpty() && !hasPending.load())
+                return;
+
+            QMutexLocker lock(&mutex);
+            for (const Hit &hit : hits) {
+                if (found >= maxResults) {
+                    stop.store(true);
+                    break;
+                }
+                QVariantMap entry;
+                entry[QStringLiteral("filePath")] = filePath;
+                entry[QStringLiteral("line")] = hit.line;
+                entry[QStringLiteral("text")] = hit.text;
+                pending.append(entry);
+                ++found;
+            }
+            // The first hits go out at once; later ones by size or age
+            const bool first = found == pending.size();
+            if (!pending.isEmpty()
+                && (first || pending.size() >= kBatchHits || sinceSend.elapsed() >= kBatchIntervalMs)) {
+                send(std::exchange(pending, {}));
+                sinceSend.restart();
+            }
+            hasPending.store(!pending.isEmpty());
+        });
+
+        if (cancel->load() || !self)
+            return;
+        if (!pending.isEmpty())
+            send(pending);
+        const bool truncated = found >= maxResults;
+        QMetaObject::invokeMethod(self, [self, generation, truncated]() {
+            if (self && self->m_searchGeneration == generation)
+                emit self->searchFinished(truncated);
+        }, Qt::QueuedConnection);
     });
 }
@@ -3,11 +3,13 @@
 #include <QObject>
 #include <QVariantList>
 #include <QStringList>
+#include <QVector>
 #include <atomic>
 #include <memory>
 
 class ProjectTreeModel;
 class ConfigManager;
+class WorkspaceIndex;
 
 class SearchManager : public QObject
 {
@@ -15,17 +17,54 @@ class SearchManager : public QObject
 
 public:
     explicit SearchManager(ProjectTreeModel *tree, ConfigManager *config,
-                           QObject *parent = nullptr);
+                           const QString &indexDir, QObject *parent = nullptr);
 
     QStringList getAllFiles() const;
     QVariantList fuzzyFilterFiles(const QString &query) const;
-    void searchFiles(const QString &query);
+
+    // Search across the project tree for a SearchQuery (literal or regular
+    // expression, optional NEAR and path filters). The workspace index
+    // rules out files that cannot match; the rest are searched in
+    // parallel on the thread pool and hits ({filePath, line, text}) arrive in
+    // batches while the search runs, then searchFinished. A query that does
+    // not compile gives searchError first. Starting a new search cancels the
+    // previous one; its batches are dropped.
+    void searchFiles(const QString &text, bool caseSensitive = false, bool wholeWord = false,
+                     bool regex = false);
+
+    // Bring the workspace index in line with the tree (after a scan) or
+    // with one file (after a save)
+    void syncIndex();
+    void refreshIndexedFile(const QString &filePath);
 
 signals:
-    void searchResultsReady(const QVariantList &results);
+    void searchResultsBatch(const QVariantList &hits);
+    void searchFinished(bool truncated);   // truncated: stopped at the result cap
+    void searchError(const QString &message);
 
 private:
+    // Quick-switcher row, lowercased once when the tree changes
+    struct FileEntry {
+        QString filePath;
+        QString fileName;
+        QString dirPath;
+        QString lowerName;
+        QString lowerPath;
+        quint64 nameMask = 0;       // see charMask()
+        quint64 pathMask = 0;
+    };
+
+    bool includeInSearch(const QString &path) const;
+    void rebuildFileTable() const;
+
     ProjectTreeModel *m_projectTreeModel;
     ConfigManager *m_configManager;
+    WorkspaceIndex *m_index;
+
+    mutable QVector<FileEntry> m_fileTable;
+    mutable bool m_fileTableStale = true;
+    mutable QString m_lastFuzzyQuery;           // lowercase
+    mutable QVector<int> m_lastFuzzyMatches;    // every entry matching it, in table order
     std::shared_ptr<std::atomic<bool>> m_searchCancel;
+    quint64 m_searchGeneration = 0;
 };
@@ -0,0 +1,360 @@
+#include "searchquery.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr int kDefaultNearDistance = 3;
+constexpr int kMaxNearDistance = 10000;
+constexpr qsizetype kMinPrefilter = 3;   // shorter literals rarely rule a file out
+
+// Index after the character class starting at `i`, or -1 when unclosed
+qsizetype skipClass(const QString &p, qsizetype i)
+{
+    const qsizetype n = p.size();
+    ++i;
+    if (i < n && p[i] == u'^')
+        ++i;
+    if (i < n && p[i] == u']')
+        ++i;   // a leading ']' is a member
+    while (i < n && p[i] != u']') {
+        if (p[i] == u'\\') {
+            ++i;
+        } else if (p[i] == u'[' && i + 1 < n && p[i + 1] == u':') {
+            const qsizetype close = p.indexOf(QStringLiteral(":]"), i + 2);
+            if (close >= 0)
+                i = close + 1;
+        }
+        ++i;
+    }
+    return i < n ? i + 1 : -1;
+}
+
+// Index after the group starting at `i`, or -1 when unbalanced
+qsizetype skipGroup(const QString &p, qsizetype i)
+{
+    const qsizetype n = p.size();
+    int depth = 0;
+    while (i < n) {
+        const QChar c = p[i];
+        if (c == u'\\') {
+            if (i + 1 < n && p[i + 1] == u'Q') {
+                const qsizetype end = p.indexOf(QStringLiteral("\\E"), i + 2);
+                if (end < 0)
+                    return -1;
+                i = end + 2;
+            } else {
+                i += 2;
+            }
+            continue;
+        }
+        if (c == u'[') {
+            i = skipClass(p, i);
+            if (i < 0)
+                return -1;
+            continue;
+        }
+        if (c == u'(')
+            ++depth;
+        else if (c == u')' && --depth == 0)
+            return i + 1;
+        ++i;
+    }
+    return -1;
+}
+
+bool isOptionalQuantifier(const QString &p, qsizetype i)
+{
+    return i < p.size() && (p[i] == u'?' || p[i] == u'*' || p[i] == u'{');
+}
+
+// Literal runs every match of the expression contains, read conservatively:
+// top-level alternation gives none, groups and classes are skipped, a
+// character under ?, * or {..} is optional, and after an escape this does
+// not know, only the runs before it count.
+QStringList regexLiterals(const QString &p)
+{
+    static const QString classEscapes = QStringLiteral("dDwWsShHvVRNbBAzZGKX");
+    const qsizetype n = p.size();
+    QStringList runs;
+    QString run;
+    bool collecting = true;
+    auto endRun = [&]() {
+        if (collecting && run.size() >= kMinPrefilter)
+            runs.append(run);
+        run.clear();
+    };
+
+    for (qsizetype i = 0; i < n;) {
+        const QChar c = p[i];
+        QString atom;
+        if (c == u'\\') {
+            if (i + 1 >= n)
+                return {};
+            const QChar e = p[i + 1];
+            if (e == u'Q') {
+                const qsizetype end = p.indexOf(QStringLiteral("\\E"), i + 2);
+                atom = p.mid(i + 2, (end < 0 ? n : end) - i - 2);
+                i = end < 0 ? n : end + 2;
+            } else if (!e.isLetterOrNumber()) {
+                atom = e;
+                i += 2;
+            } else {
+                endRun();
+                if (!classEscapes.contains(e))
+                    collecting = false;   // \x41, \p{..}, back-references...
+                i += 2;
+                continue;
+            }
+        } else if (c == u'|') {
+            return {};
+        } else if (c == u'(' || c == u'[') {
+            endRun();
+            i = c == u'(' ? skipGroup(p, i) : skipClass(p, i);
+            if (i < 0)
+                return {};
+            continue;
+        } else if (c == u'{') {
+            endRun();
+            const qsizetype close = p.indexOf(u'}', i);
+            i = close < 0 ? i + 1 : close + 1;
+            continue;
+        } else if (c == u'?' || c == u'*' || c == u'+' || c == u'.' || c == u'^' || c == u'$') {
+            endRun();
+            ++i;
+            continue;
+        } else {
+            atom = c;
+            ++i;
+        }
+
+        if (atom.isEmpty())
+            continue;
+        run += atom;
+        if (isOptionalQuantifier(p, i)) {
+            run.chop(1);
+            endRun();
+        } else if (i < n && p[i] == u'+') {
+            endRun();
+        }
+    }
+    endRun();
+    return runs;
+}
+
+// `*` and `?` stay within a segment, `**` crosses segments. A glob with a
+// '/' must match the whole project-relative path, one without matches the
+// file name.
+QRegularExpression globToRegex(QString glob)
+{
+    QString expression;
+    if (glob.contains(u'/')) {
+        expression = QStringLiteral("^");
+        if (glob.startsWith(u'/'))
+            glob.remove(0, 1);
+    } else {
+        expression = QStringLiteral("(?:^|/)");
+    }
+    for (qsizetype i = 0; i < glob.size(); ++i) {
+        const QChar c = glob[i];
+        if (c == u'*' && i + 1 < glob.size() && glob[i + 1] == u'*') {
+            if (i + 2 < glob.size() && glob[i + 2] == u'/') {
+                expression += QStringLiteral("(?:.*/)?");   // "**/" also matches no directory
+                i += 2;
+            } else {
+                expression += QStringLiteral(".*");
+                ++i;
+            }
+        } else if (c == u'*') {
+            expression += QStringLiteral("[^/]*");
+        } else if (c == u'?') {
+            expression += QStringLiteral("[^/]");
+        } else {
+            expression += QRegularExpression::escape(QString(c));
+        }
+    }
+    expression += u'$';
+    return QRegularExpression(expression, QRegularExpression::CaseInsensitiveOption);
+}
+
+} // namespace
+
+// --- Pattern ---
+
+std::optional<SearchQuery::Pattern> SearchQuery::Pattern::compile(const QString &text,
+                                                                  const Options &options,
+                                                                  QString *error)
+{
+    Pattern pattern;
+    if (!options.regex && !options.wholeWord) {
+        pattern.m_literals = { text };
+        if (options.caseSensitive) {
+            pattern.m_kind = Exact;
+            pattern.m_text = text;
+            pattern.m_utf8 = text.toUtf8();
+        } else {
+            pattern.m_kind = Folded;
+            pattern.m_matcher = TextSearch::Matcher(text);
+        }
+        return pattern;
+    }
+
+    // Whole words: no word character may touch either end of the match
+    QString expression = options.regex ? text : QRegularExpression::escape(text);
+    if (options.wholeWord)
+        expression = QStringLiteral("(?<!\\w)(?:%1)(?!\\w)").arg(expression);
+
+    QRegularExpression::PatternOptions flags = QRegularExpression::MultilineOption
+                                             | QRegularExpression::UseUnicodePropertiesOption;
+    if (!options.caseSensitive)
+        flags |= QRegularExpression::CaseInsensitiveOption;
+    pattern.m_kind = Regex;
+    pattern.m_regex = QRegularExpression(expression, flags);
+    if (!pattern.m_regex.isValid()) {
+        if (error) {
+            *error = QStringLiteral("%1 at offset %2")
+                         .arg(pattern.m_regex.errorString())
+                         .arg(pattern.m_regex.patternErrorOffset());
+        }
+        return std::nullopt;
+    }
+    // Compile (and JIT where available) now, before the workers share it
+    pattern.m_regex.optimize();
+
+    pattern.m_literals = options.regex ? regexLiterals(text) : QStringList{ text };
+    for (const QString &literal : std::as_const(pattern.m_literals))
+        pattern.m_prefilters.append(TextSearch::Matcher(literal));
+    return pattern;
+}
+
+qsizetype SearchQuery::Pattern::indexIn(QByteArrayView utf8, qsizetype from) const
+{
+    switch (m_kind) {
+    case Folded:
+        return m_matcher.indexIn(utf8, from);
+    case Exact:
+        return utf8.indexOf(m_utf8, from);
+    case Regex:
+        break;
+    }
+    Q_ASSERT_X(false, "SearchQuery::Pattern::indexIn", "expressions match decoded text");
+    return -1;
+}
+
+qsizetype SearchQuery::Pattern::indexIn(QStringView text, qsizetype from) const
+{
+    switch (m_kind) {
+    case Folded:
+        return m_matcher.indexIn(text, from);
+    case Exact:
+        return text.indexOf(m_text, from, Qt::CaseSensitive);
+    case Regex:
+        break;
+    }
+    const QRegularExpressionMatch match = m_regex.matchView(text, from);
+    return match.hasMatch() ? match.capturedStart() : -1;
+}
+
+bool SearchQuery::Pattern::mayMatch(QByteArrayView utf8) const
+{
+    return std::all_of(m_prefilters.cbegin(), m_prefilters.cend(),
+                       [utf8](const TextSearch::Matcher &m) { return m.matches(utf8); });
+}
+
+// --- SearchQuery ---
+
+std::optional<SearchQuery> SearchQuery::parse(const QString &text, const Options &options,
+                                              QString *error)
+{
+    auto fail = [error](const QString &message) {
+        if (error)
+            *error = message;
+        return std::optional<SearchQuery>();
+    };
+
+    // Pull out path filters; the rest, spaces included, is the pattern text
+    SearchQuery query;
+    QString rest;
+    const qsizetype n = text.size();
+    for (qsizetype i = 0; i < n;) {
+        const bool tokenStart = i == 0 || text[i - 1].isSpace();
+        const QStringView tail = QStringView(text).sliced(i);
+        qsizetype j = -1;
+        bool exclude = false;
+        if (tokenStart && tail.startsWith(u"path:")) {
+            j = i + 5;
+        } else if (tokenStart && tail.startsWith(u"-path:")) {
+            j = i + 6;
+            exclude = true;
+        }
+        if (j < 0) {
+            rest.append(text[i++]);
+            continue;
+        }
+
+        QString glob;
+        if (j < n && text[j] == u'"') {
+            const qsizetype close = text.indexOf(u'"', j + 1);
+            if (close < 0)
+                return fail(QStringLiteral("Unterminated string"));
+            glob = text.mid(j + 1, close - j - 1);
+            j = close + 1;
+        } else {
+            while (j < n && !text[j].isSpace())
+                glob.append(text[j++]);
+        }
+        if (glob.isEmpty())
+            return fail(QStringLiteral("Empty path filter"));
+        (exclude ? query.m_excludes : query.m_includes).append(globToRegex(glob));
+
+        // Drop the filter with the blanks around it, keeping one separator
+        while (!rest.isEmpty() && rest.back().isSpace())
+            rest.chop(1);
+        while (j < n && text[j].isSpace())
+            ++j;
+        if (!rest.isEmpty() && j < n)
+            rest.append(u' ');
+        i = j;
+    }
+
+    static const QRegularExpression nearKeyword(QStringLiteral("\\s+NEAR(?:/(\\d+))?\\s+"));
+    QStringList parts;
+    const QRegularExpressionMatch near = nearKeyword.match(rest);
+    if (near.hasMatch()) {
+        if (!near.captured(1).isEmpty())
+            query.m_nearDistance = std::min(near.captured(1).toInt(), kMaxNearDistance);
+        else
+            query.m_nearDistance = kDefaultNearDistance;
+        parts = { rest.first(near.capturedStart()), rest.sliced(near.capturedEnd()) };
+    } else {
+        parts = { rest };
+    }
+
+    for (const QString &part : std::as_const(parts)) {
+        if (part.trimmed().isEmpty())
+            return fail(QStringLiteral("Nothing to search for"));
+        std::optional<Pattern> pattern = Pattern::compile(part, options, error);
+        if (!pattern)
+            return std::nullopt;
+        query.m_patterns.append(std::move(*pattern));
+    }
+    return query;
+}
+
+bool SearchQuery::includesPath(const QString &path) const
+{
+    auto matchesAny = [&path](const QVector<QRegularExpression> &globs) {
+        return std::any_of(globs.cbegin(), globs.cend(), [&path](const QRegularExpression &glob) {
+            return glob.match(path).hasMatch();
+        });
+    };
+    return (m_includes.isEmpty() || matchesAny(m_includes)) && !matchesAny(m_excludes);
+}
+
+QStringList SearchQuery::requiredLiterals() const
+{
+    QStringList literals;
+    for (const Pattern &pattern : m_patterns)
+        literals += pattern.requiredLiterals();
+    return literals;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "textsearch.h"
+
+#include <QByteArray>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <optional>
+
+// Query for global search.
+//
+//   parseConfig path:docs/**/*.md
+//   TODO NEAR/5 release -path:*.txt
+//   ^##\s+Install                      (with the regex option)
+//
+// The text is one pattern, or two joined by NEAR (NEAR/n: a line matching
+// the first pattern with a line matching the second at most n lines away;
+// n defaults to 3). `path:GLOB` keeps only files matching one of the globs
+// and `-path:GLOB` drops files; `*` and `?` stay within a path segment and
+// `**` crosses segments. A glob with '/' is matched against the whole path
+// relative to the project root, one without '/' against the file name.
+// Globs with spaces go in double quotes. Everything else, spaces
+// included, is the pattern: a literal by default, or a regular expression.
+//
+// Compiled once per search and then shared read-only by the worker threads.
+class SearchQuery
+{
+public:
+    struct Options {
+        bool caseSensitive = false;
+        bool wholeWord = false;
+        bool regex = false;
+    };
+
+    class Pattern
+    {
+    public:
+        // Literals can be found in raw UTF-8; regular expressions need the
+        // decoded text
+        bool matchesUtf8() const { return m_kind != Regex; }
+
+        // Offset of the first match at or after `from`, or -1
+        qsizetype indexIn(QByteArrayView utf8, qsizetype from) const;
+        qsizetype indexIn(QStringView text, qsizetype from) const;
+
+        // False when the text lacks a literal every match contains, so the
+        // expression need not run
+        bool mayMatch(QByteArrayView utf8) const;
+
+        // Strings every match contains, compared case-insensitively
+        const QStringList &requiredLiterals() const { return m_literals; }
+
+    private:
+        friend class SearchQuery;
+        enum Kind { Folded, Exact, Regex };
+
+        static std::optional<Pattern> compile(const QString &text, const Options &options,
+                                              QString *error);
+
+        Kind m_kind = Folded;
+        TextSearch::Matcher m_matcher;              // Folded
+        QString m_text;                             // Exact
+        QByteArray m_utf8;                          // Exact
+        QRegularExpression m_regex;                 // Regex
+        QStringList m_literals;
+        QVector<TextSearch::Matcher> m_prefilters;  // Regex: one per literal
+    };
+
+    // Empty on a syntax error or an invalid expression; `error` says why
+    static std::optional<SearchQuery> parse(const QString &text, const Options &options,
+                                            QString *error = nullptr);
+
+    const Pattern &pattern() const { return m_patterns.first(); }
+    const Pattern *nearPattern() const { return m_patterns.size() > 1 ? &m_patterns[1] : nullptr; }
+    int nearDistance() const { return m_nearDistance; }
+
+    // `path` is relative to the project root, with '/' separators
+    bool includesPath(const QString &path) const;
+    // Strings every matching file contains, for narrowing with the index
+    QStringList requiredLiterals() const;
+
+private:
+    QVector<Pattern> m_patterns;
+    int m_nearDistance = 3;
+    QVector<QRegularExpression> m_includes;
+    QVector<QRegularExpression> m_excludes;
+};
@@ -1,14 +1,19 @@
 #include "syncengine.h"
+#include "blockscanner.h"
 #include "blockstore.h"
+#include "linediff.h"
+#include "merge3.h"
 #include "projecttreemodel.h"
 #include "utils.h"
 
 #include <QFile>
+#include <QFileInfo>
 #include <QSaveFile>
 #include <QTextStream>
-#include <QRegularExpression>
 #include <QtConcurrent>
 #include <QPointer>
+#include <algorithm>
+#include <utility>
 
 // Read file with BOM-aware encoding, stripping the BOM character
 static QString readFileContent(const QString &filePath)
@@ -31,62 +36,504 @@ static QString readFileContent(const QString &filePath)
     return content;
 }
 
+namespace {
+
+// One file as read for the index: its stat and the blocks found
+struct FileScan {
+    bool reused = false;           // stat unchanged — keep the previous entry
+    qint64 size = -1;
+    qint64 mtime = 0;
+    QVector<QPair<QString, BlockOccurrence>> blocks;   // (blockId, occurrence)
+};
+
+FileScan scanContent(const QString &filePath, const QString &content)
+{
+    FileScan scan;
+    const QFileInfo info(filePath);
+    scan.mtime = info.lastModified().toMSecsSinceEpoch();
+    if (content.isNull())
+        return scan;
+    scan.size = info.size();
+
+    const QList<BlockScanner::Span> spans = BlockScanner::scan(content);
+    scan.blocks.reserve(spans.size());
+    for (const BlockScanner::Span &span : spans) {
+        // Normalize to LF at ingestion — registry uses LF, files may use CRLF
+        QString blockContent = content.mid(span.contentStart, span.contentEnd - span.contentStart);
+        blockContent.remove(QLatin1Char('\r'));
+        const quint64 hash = Utils::contentHash(blockContent);
+        scan.blocks.append({span.id.toString(), {filePath, std::move(blockContent), hash}});
+    }
+    return scan;
+}
+
+void unindexFile(BlockIndexSnapshot &index, const QString &filePath)
+{
+    const BlockIndexSnapshot::FileBlocks *file = index.files.find(filePath);
+    if (!file)
+        return;
+
+    const QStringList blockIds = file->blockIds;
+    for (const QString &blockId : blockIds) {
+        QVector<BlockOccurrence> *occurrences = index.blocks.findMutable(blockId);
+        if (!occurrences)
+            continue;   // already dropped (block used twice in this file)
+        occurrences->removeIf([&](const BlockOccurrence &occ) { return occ.filePath == filePath; });
+        if (occurrences->isEmpty())
+            index.blocks.remove(blockId);
+    }
+}
+
+void indexFile(BlockIndexSnapshot &index, const QString &filePath, const FileScan &scan)
+{
+    unindexFile(index, filePath);
+
+    BlockIndexSnapshot::FileBlocks &file = index.files[filePath];
+    file.size = scan.size;
+    file.mtime = scan.mtime;
+    file.blockIds.clear();
+    for (const auto &block : scan.blocks) {
+        index.blocks[block.first].append(block.second);
+        file.blockIds.append(block.first);
+    }
+}
+
+// One file's part of a push: its bytes before and after the rewrite
+struct FileWrite {
+    QString filePath;
+    QByteArray original;           // restored if the push rolls back
+    QByteArray updated;
+    QString content;               // decoded `updated`, for re-indexing
+    QStringList blockIds;          // blocks actually rewritten
+    QString error;
+    bool written = false;
+    FileScan scan;
+};
+
+// Read a file and rewrite the given blocks in memory, keeping its encoding,
+// BOM and line endings. Nothing is written yet.
+FileWrite prepareWrite(const QString &filePath, const QHash<QString, QString> &blocks)
+{
+    FileWrite write;
+    write.filePath = filePath;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        write.error = SyncEngine::tr("Cannot read %1").arg(filePath);
+        return write;
+    }
+    bool hasBom = false;
+    const auto encoding = Utils::detectBomEncoding(file, hasBom);
+    write.original = file.readAll();
+
+    QStringDecoder decoder(encoding);
+    QString content = decoder(write.original);
+    if (!content.isEmpty() && content.at(0) == QChar(0xFEFF))
+        content.remove(0, 1);
+
+    // Locate every block first; a block nested in another pushed block is
+    // already covered by the outer one's content
+    struct Edit {
+        BlockScanner::Span span;   // offsets only — its views die with the first replace
+        QString blockId;
+        QString content;
+    };
+    QVector<Edit> found;
+    for (auto it = blocks.cbegin(); it != blocks.cend(); ++it) {
+        if (const auto span = BlockScanner::find(content, it.key()))
+            found.append({*span, it.key(), it.value()});
+    }
+    std::sort(found.begin(), found.end(), [](const Edit &a, const Edit &b) {
+        return a.span.start < b.span.start;
+    });
+    QVector<Edit> edits;
+    for (const Edit &edit : std::as_const(found)) {
+        if (edits.isEmpty() || edit.span.start >= edits.last().span.end)
+            edits.append(edit);
+    }
+    if (edits.isEmpty())
+        return write;
+
+    // Adapt newContent line endings to match the file (CRLF vs LF).
+    // The line breaks around the content stay as they are; a closing marker
+    // that shared the content's last line gets one of its own.
+    const bool crlf = content.contains(QStringLiteral("\r\n"));
+    for (auto it = edits.crbegin(); it != edits.crend(); ++it) {
+        const BlockScanner::Span &span = it->span;
+        QString adapted = it->content;
+        adapted.remove(QLatin1Char('\r'));        // normalize to LF first
+        if (crlf)
+            adapted.replace(QLatin1Char('\n'), QStringLiteral("\r\n"));
+        if (span.contentEnd == span.closeStart)
+            adapted += crlf ? QStringLiteral("\r\n") : QStringLiteral("\n");
+        write.blockIds.append(it->blockId);
+        content.replace(span.contentStart, span.contentEnd - span.contentStart, adapted);
+    }
+
+    QStringEncoder encoder(encoding, hasBom ? QStringConverter::Flag::WriteBom
+                                            : QStringConverter::Flag::Default);
+    write.updated = encoder(content);
+    write.content = content;
+    return write;
+}
+
+bool writeBytes(const QString &filePath, const QByteArray &bytes)
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(bytes);
+    return file.commit();
+}
+
+} // namespace
+
 SyncEngine::SyncEngine(BlockStore *blockStore, ProjectTreeModel *treeModel,
                        QObject *parent)
     : QObject(parent)
     , m_blockStore(blockStore)
     , m_treeModel(treeModel)
+    , m_snapshot(std::make_shared<const BlockIndexSnapshot>())
+{
+}
+
+SyncEngine::~SyncEngine()
 {
+    if (m_rebuildCancel)
+        m_rebuildCancel->store(true);
+}
+
+std::shared_ptr<const BlockIndexSnapshot> SyncEngine::snapshot() const
+{
+    return std::atomic_load(&m_snapshot);
+}
+
+void SyncEngine::publish(std::shared_ptr<const BlockIndexSnapshot> next)
+{
+    std::atomic_store(&m_snapshot, std::move(next));
 }
 
 void SyncEngine::rebuildIndex()
 {
-    m_index.clear();
+    if (m_rebuildCancel)
+        m_rebuildCancel->store(true);
 
-    static const QRegularExpression blockRx(
-        QStringLiteral("<!-- block:\\s*.+?\\s*\\[id:([a-f0-9]+)\\]\\s*-->\\r?\\n"
-                       "([\\s\\S]*?)\\r?\\n"
-                       "<!-- \\/block:\\1 -->"));
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    m_rebuildCancel = cancel;
+    m_rebuildStale = false;
+    const quint64 generation = ++m_rebuildGeneration;
 
-    QStringList allFiles;
-    collectAllMdFiles(m_treeModel->rootNode(), allFiles);
+    // The tree belongs to the GUI thread; everything else runs on the pool
+    const QStringList files = allMdFiles();
+    const std::shared_ptr<const BlockIndexSnapshot> base = snapshot();
 
-    for (const QString &filePath : allFiles) {
-        const QString content = readFileContent(filePath);
-        if (content.isNull()) continue;
+    QPointer<SyncEngine> self(this);
+    (void)QtConcurrent::run([self, files, base, cancel, generation]() {
+        const QVector<FileScan> scans = QtConcurrent::blockingMapped<QVector<FileScan>>(
+            files, [&base, &cancel](const QString &filePath) {
+                FileScan scan;
+                if (cancel->load())
+                    return scan;
+                const QFileInfo info(filePath);
+                const BlockIndexSnapshot::FileBlocks *known = base->files.find(filePath);
+                if (known && known->size == info.size()
+                    && known->mtime == info.lastModified().toMSecsSinceEpoch()) {
+                    scan.reused = true;
+                    return scan;
+                }
+                return scanContent(filePath, readFileContent(filePath));
+            });
+        if (cancel->load())
+            return;
 
-        auto it = blockRx.globalMatch(content);
-        while (it.hasNext()) {
-            auto match = it.next();
-            const QString blockId = match.captured(1);
-            // Normalize to LF at ingestion — registry uses LF, files may use CRLF
-            QString blockContent = match.captured(2);
-            blockContent.remove(QLatin1Char('\r'));
-            m_index[blockId].append({filePath, blockContent});
+        // Start from the previous snapshot (shared until first write) and
+        // patch only what changed
+        auto next = std::make_shared<BlockIndexSnapshot>(*base);
+        const QSet<QString> present(files.cbegin(), files.cend());
+        const QStringList known = base->files.keys();
+        for (const QString &filePath : known) {
+            if (!present.contains(filePath)) {
+                unindexFile(*next, filePath);
+                next->files.remove(filePath);
+            }
+        }
+        for (int i = 0; i < files.size(); ++i) {
+            if (!scans[i].reused)
+                indexFile(*next, files[i], scans[i]);
         }
+        if (cancel->load())
+            return;
+
+        QMetaObject::invokeMethod(self, [self, next, generation]() {
+            if (self)
+                self->finishRebuild(next, generation);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SyncEngine::finishRebuild(std::shared_ptr<const BlockIndexSnapshot> next,
+                               quint64 generation)
+{
+    if (generation != m_rebuildGeneration)
+        return;
+    m_rebuildCancel.reset();
+
+    // A save or push re-indexed files after this rebuild read them — run
+    // again from the newer snapshot rather than publish stale entries
+    if (m_rebuildStale) {
+        rebuildIndex();
+        return;
     }
+
+    publish(std::move(next));
     emit indexReady();
 }
 
-int SyncEngine::pushBlock(const QString &blockId)
+void SyncEngine::updateFile(const QString &filePath, const QString &content)
+{
+    const std::shared_ptr<const BlockIndexSnapshot> current = snapshot();
+    if (!current->files.contains(filePath))
+        return;
+
+    auto next = std::make_shared<BlockIndexSnapshot>(*current);
+    indexFile(*next, filePath, scanContent(filePath, content));
+    publish(std::move(next));
+    if (m_rebuildCancel)
+        m_rebuildStale = true;
+    emit indexReady();
+}
+
+struct SyncEngine::PushResult {
+    QString error;                     // empty when every file was written
+    QVector<FileWrite> files;          // files rewritten, with fresh scans
+    QHash<QString, QString> synced;    // blockId -> content now in registry and files
+    bool setsContent = false;          // merge: synced replaces the registry content
+    QHash<QString, quint64> registryHashes;   // merge: registry content hash each block started from
+};
+
+struct SyncEngine::MergeInput {
+    QString blockId;
+    QString base;
+    QString registry;
+    quint64 registryHash = 0;
+    QVector<BlockOccurrence> occurrences;
+};
+
+SyncEngine::PushEdits SyncEngine::collectPushEdits(const QStringList &blockIds) const
+{
+    const std::shared_ptr<const BlockIndexSnapshot> index = snapshot();
+    PushEdits edits;
+    for (const QString &blockId : blockIds) {
+        const BlockData *block = m_blockStore->findBlock(blockId);
+        const QVector<BlockOccurrence> *occurrences = index->blocks.find(blockId);
+        if (!block || !occurrences)
+            continue;
+        for (const auto &occ : *occurrences) {
+            if (occ.contentHash != block->contentHash)
+                edits[occ.filePath].insert(blockId, block->content);
+        }
+    }
+    return edits;
+}
+
+SyncEngine::PushResult SyncEngine::runPush(const PushEdits &edits)
 {
-    auto block = m_blockStore->blockById(blockId);
-    if (!block) return 0;
+    PushResult result;
+    const QStringList files = edits.keys();
+
+    // Read and rewrite in memory; any unreadable file stops the push before
+    // a single byte is written
+    QVector<FileWrite> writes = QtConcurrent::blockingMapped<QVector<FileWrite>>(
+        files, [&edits](const QString &filePath) {
+            return prepareWrite(filePath, edits.value(filePath));
+        });
+    writes.removeIf([](const FileWrite &w) { return w.error.isEmpty() && w.blockIds.isEmpty(); });
+    for (const FileWrite &w : std::as_const(writes)) {
+        if (!w.error.isEmpty()) {
+            result.error = w.error;
+            return result;
+        }
+    }
 
-    const QStringList files = filesContainingBlock(blockId);
-    int updated = 0;
+    QtConcurrent::blockingMap(writes, [](FileWrite &w) {
+        w.written = writeBytes(w.filePath, w.updated);
+        if (w.written)
+            w.scan = scanContent(w.filePath, w.content);
+    });
 
-    for (const QString &filePath : files) {
-        if (replaceBlockInFile(filePath, blockId, block->content))
-            updated++;
+    const auto failed = std::find_if(writes.cbegin(), writes.cend(),
+                                     [](const FileWrite &w) { return !w.written; });
+    if (failed != writes.cend()) {
+        result.error = tr("Cannot write %1 — push rolled back").arg(failed->filePath);
+        QtConcurrent::blockingMap(writes, [](FileWrite &w) {
+            if (w.written && !writeBytes(w.filePath, w.original))
+                qWarning("SyncEngine: could not restore %s", qPrintable(w.filePath));
+        });
+        return result;
     }
 
-    if (updated > 0) {
-        rebuildIndex();
-        emit blockPushed(blockId, updated);
+    result.files = std::move(writes);
+    for (const auto &blocks : edits) {
+        for (auto it = blocks.cbegin(); it != blocks.cend(); ++it)
+            result.synced.insert(it.key(), it.value());
     }
+    return result;
+}
+
+int SyncEngine::applyPushResult(const PushResult &result, QStringList *stale)
+{
+    if (!result.error.isEmpty()) {
+        qWarning("SyncEngine: %s", qPrintable(result.error));
+        emit pushFailed(result.error);
+        return 0;
+    }
+    // A push wrote what the registry held at dispatch; the registry may have
+    // moved on since, so only the merge base follows the files
+    if (result.setsContent) {
+        const QStringList edited = m_blockStore->setSynced(result.synced, result.registryHashes);
+        if (stale)
+            *stale = edited;
+    } else
+        m_blockStore->setSyncedBase(result.synced);
+    if (result.files.isEmpty())
+        return 0;
+
+    // Re-index exactly the rewritten files, in one snapshot swap
+    auto next = std::make_shared<BlockIndexSnapshot>(*snapshot());
+    QHash<QString, int> filesPerBlock;
+    QStringList written;
+    for (const FileWrite &w : result.files) {
+        indexFile(*next, w.filePath, w.scan);
+        written.append(w.filePath);
+        for (const QString &blockId : w.blockIds)
+            filesPerBlock[blockId]++;
+    }
+    publish(std::move(next));
+    if (m_rebuildCancel)
+        m_rebuildStale = true;
+    emit indexReady();
+    emit filesWritten(written);
 
-    return updated;
+    for (auto it = filesPerBlock.cbegin(); it != filesPerBlock.cend(); ++it)
+        emit blockPushed(it.key(), it.value());
+    return static_cast<int>(result.files.size());
+}
+
+int SyncEngine::pushBlock(const QString &blockId)
+{
+    return applyPushResult(runPush(collectPushEdits({blockId})));
+}
+
+void SyncEngine::pushBlocks(const QStringList &blockIds)
+{
+    const PushEdits edits = collectPushEdits(blockIds);
+    if (edits.isEmpty()) {
+        emit blocksPushed(blockIds, 0);
+        return;
+    }
+
+    QPointer<SyncEngine> self(this);
+    (void)QtConcurrent::run([self, blockIds, edits]() {
+        PushResult result = runPush(edits);
+        QMetaObject::invokeMethod(self, [self, blockIds, result = std::move(result)]() {
+            if (!self)
+                return;
+            const int updated = self->applyPushResult(result);
+            if (result.error.isEmpty())
+                emit self->blocksPushed(blockIds, updated);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SyncEngine::mergeBlocks(const QStringList &blockIds)
+{
+    const std::shared_ptr<const BlockIndexSnapshot> index = snapshot();
+    QVector<MergeInput> inputs;
+    for (const QString &blockId : blockIds) {
+        const BlockData *block = m_blockStore->findBlock(blockId);
+        const QVector<BlockOccurrence> *occurrences = index->blocks.find(blockId);
+        if (block && occurrences)
+            inputs.append({ blockId, block->syncedContent, block->content, block->contentHash,
+                            *occurrences });
+    }
+
+    QPointer<SyncEngine> self(this);
+    (void)QtConcurrent::run([self, inputs]() {
+        PushEdits edits;
+        QHash<QString, QString> merged;
+        QHash<QString, quint64> registryHashes;
+        QHash<QString, QString> bases;
+        QVariantList conflicts;
+        for (const MergeInput &input : inputs) {
+            // Fold each diverged file into the registry version in turn
+            QString content = input.registry;
+            bool clean = true;
+            for (const BlockOccurrence &occ : input.occurrences) {
+                if (occ.contentHash == Utils::contentHash(content))
+                    continue;
+                const Merge3::Result result = Merge3::merge(input.base, content, occ.fileContent);
+                for (const Merge3::Conflict &c : result.conflicts) {
+                    QVariantMap entry;
+                    entry[QStringLiteral("blockId")] = input.blockId;
+                    entry[QStringLiteral("filePath")] = occ.filePath;
+                    entry[QStringLiteral("baseLine")] = c.baseLine + 1;
+                    entry[QStringLiteral("base")] = c.base.join(QLatin1Char('\n'));
+                    entry[QStringLiteral("ours")] = c.ours.join(QLatin1Char('\n'));
+                    entry[QStringLiteral("theirs")] = c.theirs.join(QLatin1Char('\n'));
+                    conflicts.append(entry);
+                }
+                if (result.conflicts.isEmpty())
+                    content = result.merged;
+                else
+                    clean = false;
+            }
+            if (!clean)
+                continue;
+
+            merged.insert(input.blockId, content);
+            registryHashes.insert(input.blockId, input.registryHash);
+            bases.insert(input.blockId, input.base);
+            const quint64 hash = Utils::contentHash(content);
+            for (const BlockOccurrence &occ : input.occurrences) {
+                if (occ.contentHash != hash)
+                    edits[occ.filePath].insert(input.blockId, content);
+            }
+        }
+
+        PushResult result = edits.isEmpty() ? PushResult() : runPush(edits);
+        if (result.error.isEmpty()) {
+            result.synced = merged;   // includes blocks only the registry takes
+            result.setsContent = true;
+            result.registryHashes = registryHashes;
+        }
+        QMetaObject::invokeMethod(self, [self, result = std::move(result), conflicts, bases]() mutable {
+            if (!self)
+                return;
+            QStringList stale;
+            const int updated = self->applyPushResult(result, &stale);
+            if (!result.error.isEmpty())
+                return;
+            if (updated == 0 && !result.synced.isEmpty())
+                emit self->indexReady();   // only the registry side changed
+
+            // Edited in the registry while the merge ran: the files hold the
+            // merge, the registry keeps the edit, and the block is reported
+            QStringList mergedIds = result.synced.keys();
+            for (const QString &blockId : std::as_const(stale)) {
+                mergedIds.removeAll(blockId);
+                const BlockData *block = self->m_blockStore->findBlock(blockId);
+                QVariantMap entry;
+                entry[QStringLiteral("blockId")] = blockId;
+                entry[QStringLiteral("filePath")] = QString();
+                entry[QStringLiteral("baseLine")] = 0;
+                entry[QStringLiteral("base")] = bases.value(blockId);
+                entry[QStringLiteral("ours")] = block ? block->content : QString();
+                entry[QStringLiteral("theirs")] = result.synced.value(blockId);
+                conflicts.append(entry);
+            }
+            emit self->blocksMerged(mergedIds, updated, conflicts);
+        }, Qt::QueuedConnection);
+    });
 }
 
 void SyncEngine::pullBlock(const QString &blockId, const QString &filePath)
@@ -100,17 +547,19 @@ void SyncEngine::pullBlock(const QString &blockId, const QString &filePath)
 
     // Normalize to LF before storing in registry
     fileContent.remove(QLatin1Char('\r'));
-    m_blockStore->updateBlock(blockId, fileContent);
-    rebuildIndex();
+    m_blockStore->setSynced({{blockId, fileContent}});
+    // Only the registry changed — the file index is still current, but sync
+    // status shown from it is not
+    emit indexReady();
     emit blockPulled(blockId, filePath);
 }
 
 QStringList SyncEngine::filesContainingBlock(const QString &blockId) const
 {
+    const std::shared_ptr<const BlockIndexSnapshot> index = snapshot();
     QStringList result;
-    auto it = m_index.constFind(blockId);
-    if (it != m_index.constEnd()) {
-        for (const auto &occ : it.value())
+    if (const QVector<BlockOccurrence> *occurrences = index->blocks.find(blockId)) {
+        for (const auto &occ : *occurrences)
             result.append(occ.filePath);
     }
     return result;
@@ -118,18 +567,19 @@ QStringList SyncEngine::filesContainingBlock(const QString &blockId) const
 
 QVariantList SyncEngine::blockSyncStatus(const QString &blockId) const
 {
-    auto block = m_blockStore->blockById(blockId);
+    const BlockData *block = m_blockStore->findBlock(blockId);
     if (!block) return {};
 
+    const std::shared_ptr<const BlockIndexSnapshot> index = snapshot();
     QVariantList result;
-    auto it = m_index.constFind(blockId);
-    if (it == m_index.constEnd())
+    const QVector<BlockOccurrence> *occurrences = index->blocks.find(blockId);
+    if (!occurrences)
         return result;
 
-    for (const auto &occ : it.value()) {
+    for (const auto &occ : *occurrences) {
         QVariantMap entry;
         entry[QStringLiteral("filePath")] = occ.filePath;
-        bool synced = (occ.fileContent == block->content);
+        bool synced = (occ.contentHash == block->contentHash);
         entry[QStringLiteral("status")] = synced
             ? QStringLiteral("synced") : QStringLiteral("diverged");
         if (!synced)
@@ -142,144 +592,139 @@ QVariantList SyncEngine::blockSyncStatus(const QString &blockId) const
 
 bool SyncEngine::isBlockDiverged(const QString &blockId) const
 {
-    auto block = m_blockStore->blockById(blockId);
+    const BlockData *block = m_blockStore->findBlock(blockId);
     if (!block) return false;
 
-    auto it = m_index.constFind(blockId);
-    if (it == m_index.constEnd())
+    const std::shared_ptr<const BlockIndexSnapshot> index = snapshot();
+    const QVector<BlockOccurrence> *occurrences = index->blocks.find(blockId);
+    if (!occurrences)
         return false;
 
-    for (const auto &occ : it.value()) {
-        if (occ.fileContent != block->content)
+    for (const auto &occ : *occurrences) {
+        if (occ.contentHash != block->contentHash)
             return true;
     }
     return false;
 }
 
-// --- Myers diff algorithm (operates on lines) ---
-
-// Compute LCS-based edit script between two line arrays.
-// Returns a flat list of diff entries for the QML side.
-static QVariantList myersDiff(const QStringList &a, const QStringList &b)
+QStringList SyncEngine::divergedBlockIds() const
 {
-    const int n = a.size();
-    const int m = b.size();
-    const int max = n + m;
-
-    if (max == 0)
-        return {};
-
-    // V array indexed by k ∈ [-max, max], offset by max
-    QVector<int> v(2 * max + 1, 0);
-
-    // Trace: for each d, store the V snapshot to reconstruct the path
-    QVector<QVector<int>> trace;
-
-    bool found = false;
-    for (int d = 0; d <= max && !found; d++) {
-        trace.append(v);
-        for (int k = -d; k <= d; k += 2) {
-            int x;
-            if (k == -d || (k != d && v[k - 1 + max] < v[k + 1 + max]))
-                x = v[k + 1 + max];        // move down (insert)
-            else
-                x = v[k - 1 + max] + 1;    // move right (delete)
-
-            int y = x - k;
-
-            // Follow diagonal (equal lines)
-            while (x < n && y < m && a[x] == b[y]) {
-                x++;
-                y++;
-            }
-
-            v[k + max] = x;
-
-            if (x >= n && y >= m) {
-                found = true;
+    const std::shared_ptr<const BlockIndexSnapshot> index = snapshot();
+    QStringList result;
+    index->blocks.forEach([&](const QString &blockId, const QVector<BlockOccurrence> &occurrences) {
+        const BlockData *block = m_blockStore->findBlock(blockId);
+        if (!block)
+            return;
+        for (const auto &occ : occurrences) {
+            if (occ.contentHash != block->contentHash) {
+                result.append(blockId);
                 break;
             }
         }
-    }
-
-    // Backtrack to build the edit sequence
-    struct Edit { char type; int idxA; int idxB; };  // 'E'qual, 'D'elete, 'I'nsert
-    QVector<Edit> editsRev;
+    });
+    return result;
+}
 
-    int x = n, y = m;
-    for (int d = trace.size() - 1; d >= 0 && (x > 0 || y > 0); d--) {
-        const auto &vd = trace[d];
-        int k = x - y;
+// --- Line diff ---
 
-        int prevK;
-        if (k == -d || (k != d && vd[k - 1 + max] < vd[k + 1 + max]))
-            prevK = k + 1;  // came from insert
-        else
-            prevK = k - 1;  // came from delete
+namespace {
 
-        int prevX = vd[prevK + max];
-        int prevY = prevX - prevK;
+constexpr int kDiffChunkLines = 2000;
 
-        // Diagonal moves (equal lines)
-        while (x > prevX && y > prevY) {
-            x--; y--;
-            editsRev.append({'E', x, y});
-        }
+QStringList splitLines(QString text)
+{
+    // Normalize to LF before splitting into lines
+    text.remove(QLatin1Char('\r'));
+    return text.split(QLatin1Char('\n'));
+}
 
-        if (d > 0) {
-            if (x == prevX) {
-                // Insert
-                y--;
-                editsRev.append({'I', -1, y});
-            } else {
-                // Delete
-                x--;
-                editsRev.append({'D', x, -1});
-            }
-        }
+QVariantList spansToVariant(const QVector<LineDiff::Span> &spans)
+{
+    QVariantList out;
+    out.reserve(spans.size());
+    for (const LineDiff::Span &span : spans) {
+        QVariantMap entry;
+        entry[QStringLiteral("start")] = span.start;
+        entry[QStringLiteral("length")] = span.length;
+        out.append(entry);
     }
+    return out;
+}
 
-    // Convert edit script to QVariantList for QML
-    QVariantList result;
-    result.reserve(editsRev.size());
-    int lineA = 1, lineB = 1;
-
-    for (int i = editsRev.size() - 1; i >= 0; i--) {
-        const auto &e = editsRev[i];
+// Flatten hunks into the QML line list. Unchanged lines left out between
+// hunks become one "skip" row; `flush` is called whenever a chunk fills up.
+// Removed and added lines are paired up in order and carry the changed
+// character ranges of the pair as "spans".
+template <typename Flush>
+void appendDiffLines(const QStringList &a, const QStringList &b,
+                     const QVector<LineDiff::Hunk> &hunks, QVariantList &lines, Flush flush)
+{
+    auto push = [&](const QString &type, const QString &text, int lineA, int lineB,
+                    const QVector<LineDiff::Span> &spans = {}) {
         QVariantMap entry;
-        switch (e.type) {
-        case 'E':
-            entry[QStringLiteral("type")] = QStringLiteral("context");
-            entry[QStringLiteral("text")] = a[e.idxA];
-            entry[QStringLiteral("lineA")] = lineA++;
-            entry[QStringLiteral("lineB")] = lineB++;
-            break;
-        case 'D':
-            entry[QStringLiteral("type")] = QStringLiteral("removed");
-            entry[QStringLiteral("text")] = a[e.idxA];
-            entry[QStringLiteral("lineA")] = lineA++;
-            entry[QStringLiteral("lineB")] = -1;
-            break;
-        case 'I':
-            entry[QStringLiteral("type")] = QStringLiteral("added");
-            entry[QStringLiteral("text")] = b[e.idxB];
-            entry[QStringLiteral("lineA")] = -1;
-            entry[QStringLiteral("lineB")] = lineB++;
-            break;
+        entry[QStringLiteral("type")] = type;
+        entry[QStringLiteral("text")] = text;
+        entry[QStringLiteral("lineA")] = lineA;
+        entry[QStringLiteral("lineB")] = lineB;
+        if (!spans.isEmpty())
+            entry[QStringLiteral("spans")] = spansToVariant(spans);
+        lines.append(entry);
+        if (lines.size() >= kDiffChunkLines)
+            flush();
+    };
+
+    int nextA = 0, nextB = 0;   // first lines not shown yet
+    auto skipTo = [&](int a0, int b0) {
+        if (a0 > nextA) {
+            QVariantMap entry;
+            entry[QStringLiteral("type")] = QStringLiteral("skip");
+            entry[QStringLiteral("count")] = a0 - nextA;
+            entry[QStringLiteral("lineA")] = nextA + 1;
+            entry[QStringLiteral("lineB")] = nextB + 1;
+            lines.append(entry);
         }
-        result.append(entry);
+        nextA = a0;
+        nextB = b0;
+    };
+
+    for (const LineDiff::Hunk &hunk : hunks) {
+        skipTo(hunk.aStart, hunk.bStart);
+        for (const LineDiff::Run &run : hunk.runs) {
+            if (run.equal) {
+                for (int i = 0; i < run.aCount; ++i)
+                    push(QStringLiteral("context"), a[run.aStart + i],
+                         run.aStart + i + 1, run.bStart + i + 1);
+                continue;
+            }
+            const int pairs = std::min(run.aCount, run.bCount);
+            QVector<QVector<LineDiff::Span>> addedSpans(pairs);
+            for (int i = 0; i < run.aCount; ++i) {
+                QVector<LineDiff::Span> removedSpans;
+                if (i < pairs)
+                    LineDiff::wordDiff(a[run.aStart + i], b[run.bStart + i],
+                                       removedSpans, addedSpans[i]);
+                push(QStringLiteral("removed"), a[run.aStart + i], run.aStart + i + 1, -1,
+                     removedSpans);
+            }
+            for (int i = 0; i < run.bCount; ++i)
+                push(QStringLiteral("added"), b[run.bStart + i], -1, run.bStart + i + 1,
+                     i < pairs ? addedSpans[i] : QVector<LineDiff::Span>());
+        }
+        nextA = hunk.aStart + hunk.aCount;
+        nextB = hunk.bStart + hunk.bCount;
     }
-
-    return result;
+    skipTo(int(a.size()), int(b.size()));
 }
 
+} // namespace
+
 QVariantList SyncEngine::computeLineDiff(const QString &textA, const QString &textB) const
 {
-    // Normalize to LF before splitting into lines
-    QString a = textA, b = textB;
-    a.remove(QLatin1Char('\r'));
-    b.remove(QLatin1Char('\r'));
-    return myersDiff(a.split(QLatin1Char('\n')), b.split(QLatin1Char('\n')));
+    const QStringList a = splitLines(textA);
+    const QStringList b = splitLines(textB);
+    QVariantList lines;
+    appendDiffLines(a, b, LineDiff::hunks(LineDiff::diff(a, b), -1), lines, [] {});
+    return lines;
 }
 
 void SyncEngine::computeLineDiffAsync(const QString &requestId,
@@ -291,81 +736,47 @@ void SyncEngine::computeLineDiffAsync(const QString &requestId,
         if (!self)
             return;
 
-        const QVariantList diff = self->computeLineDiff(textA, textB);
-        if (!self)
-            return;
-
-        QMetaObject::invokeMethod(self, [self, requestId, diff]() {
-            if (!self)
-                return;
-            emit self->lineDiffReady(requestId, diff);
+        const QStringList a = splitLines(textA);
+        const QStringList b = splitLines(textB);
+        const LineDiff::Options options;
+        const QVector<LineDiff::Hunk> hunks =
+            LineDiff::hunks(LineDiff::diff(a, b, options), options.contextLines);
+
+        // Hand lines to the UI in chunks as they are formatted
+        QVariantList lines;
+        auto flush = [&]() {
+            QMetaObject::invokeMethod(self, [self, requestId, chunk = std::exchange(lines, {})]() {
+                if (self)
+                    emit self->lineDiffChunk(requestId, chunk);
+            }, Qt::QueuedConnection);
+        };
+        appendDiffLines(a, b, hunks, lines, flush);
+        if (!lines.isEmpty())
+            flush();
+
+        QMetaObject::invokeMethod(self, [self, requestId]() {
+            if (self)
+                emit self->lineDiffFinished(requestId);
         }, Qt::QueuedConnection);
     });
 }
 
-QString SyncEngine::extractBlockContent(const QString &fileContent, const QString &blockId) const
+void SyncEngine::diffBlockVersionsAsync(const QString &requestId, const QString &blockId,
+                                        int versionA, int versionB)
 {
-    QString pattern = QString(
-        "<!-- block:\\s*.+?\\s*\\[id:%1\\]\\s*-->\\r?\\n([\\s\\S]*?)\\r?\\n<!-- \\/block:%1 -->")
-        .arg(QRegularExpression::escape(blockId));
-
-    QRegularExpression rx(pattern);
-    auto match = rx.match(fileContent);
-    if (!match.hasMatch())
-        return {};
-
-    return match.captured(1);
+    // Materializing is bounded (one snapshot plus a short delta chain), so
+    // only the diff itself goes to the pool
+    computeLineDiffAsync(requestId, m_blockStore->blockVersion(blockId, versionA),
+                         m_blockStore->blockVersion(blockId, versionB));
 }
 
-bool SyncEngine::replaceBlockInFile(const QString &filePath, const QString &blockId,
-                                     const QString &newContent)
+QString SyncEngine::extractBlockContent(const QString &fileContent, const QString &blockId) const
 {
-    // Read with encoding detection
-    QFile readFile(filePath);
-    if (!readFile.open(QIODevice::ReadOnly))
-        return false;
-
-    bool hasBom = false;
-    auto encoding = Utils::detectBomEncoding(readFile, hasBom);
-
-    QTextStream in(&readFile);
-    in.setEncoding(encoding);
-    QString content = in.readAll();
-    readFile.close();
-
-    // Strip BOM character
-    if (!content.isEmpty() && content.at(0) == QChar(0xFEFF))
-        content.remove(0, 1);
-
-    QString pattern = QString(
-        "(<!-- block:\\s*.+?\\s*\\[id:%1\\]\\s*-->\\r?\\n)[\\s\\S]*?(\\r?\\n<!-- \\/block:%1 -->)")
-        .arg(QRegularExpression::escape(blockId));
-
-    QRegularExpression rx(pattern);
-    auto match = rx.match(content);
-    if (!match.hasMatch())
-        return false;
-
-    // Adapt newContent line endings to match the file (CRLF vs LF).
-    // captured(1) ends with \r?\n, captured(2) starts with \r?\n — no extra separator needed.
-    QString adapted = newContent;
-    adapted.remove(QLatin1Char('\r'));        // normalize to LF first
-    if (content.contains(QStringLiteral("\r\n")))
-        adapted.replace(QLatin1Char('\n'), QStringLiteral("\r\n"));
-    QString replacement = match.captured(1) + adapted + match.captured(2);
-    content.replace(match.capturedStart(), match.capturedLength(), replacement);
-
-    // Write back with original encoding preserved
-    QSaveFile writeFile(filePath);
-    if (!writeFile.open(QIODevice::WriteOnly))
-        return false;
+    const auto span = BlockScanner::find(fileContent, blockId);
+    if (!span)
+        return {};
 
-    QTextStream out(&writeFile);
-    out.setEncoding(encoding);
-    out.setGenerateByteOrderMark(hasBom);
-    out << content;
-    out.flush();
-    return writeFile.commit();
+    return fileContent.mid(span->contentStart, span->contentEnd - span->contentStart);
 }
 
 QStringList SyncEngine::allMdFiles() const
@@ -4,8 +4,12 @@
 #include <QString>
 #include <QStringList>
 #include <QHash>
+#include <QSet>
 #include <QVariantList>
 #include <QtQml/qqmlregistration.h>
+#include <array>
+#include <atomic>
+#include <memory>
 
 class BlockStore;
 class ProjectTreeModel;
@@ -15,9 +19,98 @@ class TreeNode;
 struct BlockOccurrence {
     QString filePath;
     QString fileContent;   // extracted content between block markers
+    quint64 contentHash = 0;   // Utils::contentHash(fileContent)
 };
 
-using BlockIndex = QHash<QString, QVector<BlockOccurrence>>;
+// String-keyed hash split into kShards shards behind shared pointers.
+// Copying shares every shard; a write copies only the shard it touches, so
+// patching a copy for one file costs a fraction of the index, not all of it.
+template <typename V>
+class ShardedHash
+{
+public:
+    static constexpr int kShards = 64;
+
+    // Null when absent
+    const V *find(const QString &key) const
+    {
+        const auto &shard = m_shards[shardOf(key)];
+        if (!shard)
+            return nullptr;
+        const auto it = shard->constFind(key);
+        return it == shard->cend() ? nullptr : &it.value();
+    }
+    bool contains(const QString &key) const { return find(key) != nullptr; }
+
+    // Writable entry, or null when absent (nothing is copied then)
+    V *findMutable(const QString &key)
+    {
+        if (!contains(key))
+            return nullptr;
+        return &writable(shardOf(key))[key];
+    }
+    V &operator[](const QString &key) { return writable(shardOf(key))[key]; }
+    void remove(const QString &key)
+    {
+        if (contains(key))
+            writable(shardOf(key)).remove(key);
+    }
+
+    QStringList keys() const
+    {
+        QStringList result;
+        for (const auto &shard : m_shards) {
+            if (shard)
+                result += shard->keys();
+        }
+        return result;
+    }
+
+    // f(key, value) for every entry, in no particular order
+    template <typename F>
+    void forEach(F f) const
+    {
+        for (const auto &shard : m_shards) {
+            if (!shard)
+                continue;
+            for (auto it = shard->cbegin(); it != shard->cend(); ++it)
+                f(it.key(), it.value());
+        }
+    }
+
+private:
+    static int shardOf(const QString &key) { return int(qHash(key) % kShards); }
+
+    QHash<QString, V> &writable(int index)
+    {
+        auto &shard = m_shards[index];
+        if (!shard)
+            shard = std::make_shared<QHash<QString, V>>();
+        else if (shard.use_count() > 1)
+            shard = std::make_shared<QHash<QString, V>>(*shard);
+        return *shard;
+    }
+
+    std::array<std::shared_ptr<QHash<QString, V>>, kShards> m_shards;
+};
+
+using BlockIndex = ShardedHash<QVector<BlockOccurrence>>;
+
+// Immutable view of the block index. Rebuilds produce a new snapshot on the
+// thread pool and swap it in; readers keep whichever one they loaded.
+// Copying one shares all shards with it (see ShardedHash).
+struct BlockIndexSnapshot {
+    // Stat at last scan plus the block IDs found, so a file's occurrences can
+    // be dropped from `blocks` without touching other files
+    struct FileBlocks {
+        qint64 size = -1;          // -1: unreadable, retried on the next pass
+        qint64 mtime = 0;          // msecs since epoch
+        QStringList blockIds;
+    };
+
+    BlockIndex blocks;                     // blockId -> occurrences
+    ShardedHash<FileBlocks> files;         // every indexed markdown file
+};
 
 class SyncEngine : public QObject
 {
@@ -28,10 +121,25 @@ class SyncEngine : public QObject
 public:
     explicit SyncEngine(BlockStore *blockStore, ProjectTreeModel *treeModel,
                         QObject *parent = nullptr);
+    ~SyncEngine() override;
 
     // Push a block's content from registry to all files that contain it
     Q_INVOKABLE int pushBlock(const QString &blockId);
 
+    // Push several blocks on the thread pool. Edits are grouped so each file
+    // is rewritten once, and the push is all-or-nothing: if any file cannot
+    // be read or written, files already written are restored. Finishes with
+    // blocksPushed or pushFailed.
+    Q_INVOKABLE void pushBlocks(const QStringList &blockIds);
+
+    // Three-way merge diverged blocks on the thread pool, with each block's
+    // last-synced content as the base. Diverged files are merged into the
+    // registry version one after another; when all merge cleanly the result
+    // goes to the registry and, in one all-or-nothing batch, to every file.
+    // Blocks with conflicts are left as they are. Finishes with blocksMerged
+    // or pushFailed.
+    Q_INVOKABLE void mergeBlocks(const QStringList &blockIds);
+
     // Pull a block's content from a specific file into the registry
     Q_INVOKABLE void pullBlock(const QString &blockId, const QString &filePath);
 
@@ -44,34 +152,76 @@ public:
     // Returns true if any file containing this block has diverged content
     Q_INVOKABLE bool isBlockDiverged(const QString &blockId) const;
 
+    // Blocks with at least one diverged occurrence
+    Q_INVOKABLE QStringList divergedBlockIds() const;
+
     // Compute line-level diff between two texts (reusable, pure function)
-    // Returns list of {type: "context"|"added"|"removed", text, lineA, lineB}
+    // Returns list of {type: "context"|"added"|"removed", text, lineA, lineB}.
+    // Paired removed/added lines also carry spans: [{start, length}] of the
+    // characters that changed.
     Q_INVOKABLE QVariantList computeLineDiff(const QString &textA, const QString &textB) const;
+    // Same rows on the thread pool, limited to hunks with 3 lines of context;
+    // longer unchanged stretches become {type: "skip", count, lineA, lineB}.
+    // Rows arrive through lineDiffChunk, then lineDiffFinished.
     Q_INVOKABLE void computeLineDiffAsync(const QString &requestId,
                                           const QString &textA,
                                           const QString &textB);
 
+    // Diff two versions of a block (see BlockStore::blockVersions), streamed
+    // the same way
+    Q_INVOKABLE void diffBlockVersionsAsync(const QString &requestId, const QString &blockId,
+                                            int versionA, int versionB);
+
     // Get all .md file paths from the project tree
     QStringList allMdFiles() const;
 
-    // Rebuild the block index (scans all project .md files)
+    // Bring the block index up to date with the project tree. Files whose
+    // size or modification time changed are re-read in parallel on the thread
+    // pool; indexReady fires once the new snapshot is swapped in.
     Q_INVOKABLE void rebuildIndex();
 
+    // Re-index one file from content already in memory (e.g. a just-saved
+    // document). Files not yet in the index are picked up by the next scan.
+    Q_INVOKABLE void updateFile(const QString &filePath, const QString &content);
+
 signals:
     void blockPushed(const QString &blockId, int fileCount);
+    // Files a push or merge rewrote, after the block index has them
+    void filesWritten(const QStringList &filePaths);
     void blockPulled(const QString &blockId, const QString &filePath);
+    void blocksPushed(const QStringList &blockIds, int fileCount);
+    void pushFailed(const QString &error);
+    // conflicts: [{blockId, filePath, baseLine, base, ours, theirs}], ours
+    // being the registry side; blocks listed there were not merged. A block
+    // edited in the registry while the merge ran is listed with an empty
+    // filePath and the merge result as theirs.
+    void blocksMerged(const QStringList &blockIds, int fileCount, const QVariantList &conflicts);
     void indexReady();
-    void lineDiffReady(const QString &requestId, const QVariantList &diff);
+    void lineDiffChunk(const QString &requestId, const QVariantList &lines);
+    void lineDiffFinished(const QString &requestId);
 
 private:
     QString extractBlockContent(const QString &fileContent, const QString &blockId) const;
-    bool replaceBlockInFile(const QString &filePath, const QString &blockId,
-                            const QString &newContent);
     void collectAllMdFiles(TreeNode *node, QStringList &files) const;
+    std::shared_ptr<const BlockIndexSnapshot> snapshot() const;
+    void publish(std::shared_ptr<const BlockIndexSnapshot> next);
+    void finishRebuild(std::shared_ptr<const BlockIndexSnapshot> next, quint64 generation);
+
+    // filePath -> (blockId -> registry content) for occurrences that differ
+    using PushEdits = QHash<QString, QHash<QString, QString>>;
+    struct PushResult;
+    PushEdits collectPushEdits(const QStringList &blockIds) const;
+    static PushResult runPush(const PushEdits &edits);
+    struct MergeInput;
+    int applyPushResult(const PushResult &result, QStringList *stale = nullptr);
 
     BlockStore *m_blockStore;
     ProjectTreeModel *m_treeModel;
 
-    // Cache: blockId -> list of occurrences (file + content)
-    BlockIndex m_index;
+    // Current index; replaced whole, never modified in place
+    std::shared_ptr<const BlockIndexSnapshot> m_snapshot;
+
+    std::shared_ptr<std::atomic<bool>> m_rebuildCancel;
+    quint64 m_rebuildGeneration = 0;
+    bool m_rebuildStale = false;   // files re-indexed locally while a rebuild ran
 };
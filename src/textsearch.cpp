@@ -0,0 +1,227 @@
+#include "textsearch.h"
+
+#include <QtAlgorithms>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#  include <emmintrin.h>
+#  define TEXTSEARCH_SSE2
+#endif
+
+namespace {
+
+constexpr qsizetype kFirstWindow = 4096;   // bytes decoded by the first Unicode pass
+
+// Encodings of the non-ASCII characters Qt folds onto 'k' and 's'
+constexpr char16_t kKelvinSign = 0x212A;
+constexpr char16_t kLongS = 0x017F;
+constexpr QByteArrayView kKelvinSignUtf8("\xE2\x84\xAA");
+constexpr QByteArrayView kLongSUtf8("\xC5\xBF");
+
+template <typename Char>
+Char foldAscii(Char c)
+{
+    return (c >= 'A' && c <= 'Z') ? Char(c + ('a' - 'A')) : c;
+}
+
+char upperAscii(char c)
+{
+    return (c >= 'a' && c <= 'z') ? char(c - ('a' - 'A')) : c;
+}
+
+// `text` equals the lowercase ASCII `needle` under ASCII case folding
+template <typename Char>
+bool equalsFolded(const Char *text, const char *needle, qsizetype length)
+{
+    for (qsizetype k = 0; k < length; ++k) {
+        if (foldAscii(text[k]) != Char(needle[k]))
+            return false;
+    }
+    return true;
+}
+
+#ifdef TEXTSEARCH_SSE2
+template <typename Char>
+struct Lanes;
+
+template <>
+struct Lanes<char>
+{
+    static constexpr qsizetype kCount = 16;
+    static constexpr int kMaskBits = 1;   // movemask bits per lane
+    static __m128i splat(char c) { return _mm_set1_epi8(c); }
+    static __m128i equal(__m128i a, __m128i b) { return _mm_cmpeq_epi8(a, b); }
+    static quint32 mask(__m128i m) { return quint32(_mm_movemask_epi8(m)); }
+};
+
+template <>
+struct Lanes<char16_t>
+{
+    static constexpr qsizetype kCount = 8;
+    static constexpr int kMaskBits = 2;
+    static __m128i splat(char c) { return _mm_set1_epi16(short(c)); }
+    static __m128i equal(__m128i a, __m128i b) { return _mm_cmpeq_epi16(a, b); }
+    static quint32 mask(__m128i m) { return quint32(_mm_movemask_epi8(m)) & 0x5555u; }
+};
+#endif
+
+// First match of the lowercase ASCII `needle` in text[from, size), or -1
+template <typename Char>
+qsizetype findAscii(const Char *text, qsizetype size, QByteArrayView needle, qsizetype from)
+{
+    const qsizetype length = needle.size();
+    const qsizetype last = size - length;   // last possible match start
+    const char *rest = needle.data() + 1;
+    qsizetype i = from;
+
+#ifdef TEXTSEARCH_SSE2
+    // Candidates are positions whose first and last characters both match;
+    // the characters between them are verified one by one
+    using L = Lanes<Char>;
+    const char first = needle.front();
+    const char final = needle.back();
+    const __m128i firstLower = L::splat(first);
+    const __m128i firstUpper = L::splat(upperAscii(first));
+    const __m128i finalLower = L::splat(final);
+    const __m128i finalUpper = L::splat(upperAscii(final));
+    for (; i + L::kCount - 1 <= last; i += L::kCount) {
+        const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i));
+        const __m128i tail =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i + length - 1));
+        const __m128i hit = _mm_and_si128(
+            _mm_or_si128(L::equal(head, firstLower), L::equal(head, firstUpper)),
+            _mm_or_si128(L::equal(tail, finalLower), L::equal(tail, finalUpper)));
+        for (quint32 bits = L::mask(hit); bits; bits &= bits - 1) {
+            const qsizetype at = i + qCountTrailingZeroBits(bits) / L::kMaskBits;
+            if (length <= 2 || equalsFolded(text + at + 1, rest, length - 2))
+                return at;
+        }
+    }
+#endif
+
+    for (; i <= last; ++i) {
+        if (foldAscii(text[i]) == Char(needle.front())
+            && equalsFolded(text + i + 1, rest, length - 1))
+            return i;
+    }
+    return -1;
+}
+
+// Byte offset of UTF-16 index `units` in `utf8`, stepping over sequences the
+// way QString::fromUtf8 decodes them (one unit per invalid byte)
+qsizetype utf8Offset(QByteArrayView utf8, qsizetype units)
+{
+    auto continuation = [&](qsizetype i) {
+        return i < utf8.size() && (uchar(utf8[i]) & 0xC0) == 0x80;
+    };
+    qsizetype i = 0;
+    while (units > 0 && i < utf8.size()) {
+        const uchar lead = uchar(utf8[i]);
+        qsizetype length = 1;
+        if (lead >= 0xC2 && lead <= 0xDF && continuation(i + 1))
+            length = 2;
+        else if (lead >= 0xE0 && lead <= 0xEF && continuation(i + 1) && continuation(i + 2))
+            length = 3;
+        else if (lead >= 0xF0 && lead <= 0xF4 && continuation(i + 1) && continuation(i + 2)
+                 && continuation(i + 3))
+            length = 4;
+        units -= length == 4 ? 2 : 1;
+        i += length;
+    }
+    return i;
+}
+
+bool isContinuation(char c)
+{
+    return (uchar(c) & 0xC0) == 0x80;
+}
+
+// First case-insensitive match of `needle` in utf8[from, end), or -1.
+// `from` must be at a character boundary. The range is decoded in windows
+// that double in size and overlap by the longest match, so a call costs
+// about the distance to its match rather than the rest of the text.
+qsizetype findUnicode(QByteArrayView utf8, qsizetype from, qsizetype end, const QString &needle)
+{
+    const qsizetype reach = 3 * needle.size();   // bytes one match can span
+    qsizetype window = std::max(kFirstWindow, 4 * reach);
+    qsizetype start = from;
+    while (start < end) {
+        qsizetype stop = std::min(end, start + window);
+        while (stop < end && isContinuation(utf8[stop]))
+            --stop;
+        const QByteArrayView chunk = utf8.sliced(start, stop - start);
+        const qsizetype at = QString::fromUtf8(chunk).indexOf(needle, 0, Qt::CaseInsensitive);
+        if (at >= 0)
+            return start + utf8Offset(chunk, at);
+        if (stop == end)
+            break;
+        start = stop - reach;
+        while (start < stop && isContinuation(utf8[start]))
+            ++start;
+        window *= 2;
+    }
+    return -1;
+}
+
+} // namespace
+
+namespace TextSearch {
+
+Matcher::Matcher(const QString &needle)
+    : m_needle(needle)
+{
+    for (QChar c : needle)
+        m_ascii = m_ascii && c.unicode() < 0x80;
+    if (m_ascii) {
+        m_folded = needle.toLower().toLatin1();
+        m_foldsFromNonAscii = m_folded.contains('k') || m_folded.contains('s');
+    }
+}
+
+qsizetype Matcher::indexIn(QByteArrayView utf8, qsizetype from) const
+{
+    if (from < 0 || from > utf8.size())
+        return -1;
+    if (m_needle.isEmpty())
+        return from;
+
+    if (m_ascii) {
+        const qsizetype pos = findAscii(utf8.data(), utf8.size(), m_folded, from);
+        if (!m_foldsFromNonAscii)
+            return pos;
+        // An earlier Unicode match would have to contain a folding character
+        // within the needle's (at most 3-byte-per-character) reach of `pos`
+        const qsizetype end = pos < 0
+            ? utf8.size()
+            : std::min(utf8.size(), pos + 3 * m_folded.size() + 2);
+        const QByteArrayView window = utf8.sliced(from, end - from);
+        if (!window.contains(kKelvinSignUtf8) && !window.contains(kLongSUtf8))
+            return pos;
+        const qsizetype at = findUnicode(utf8, from, end, m_needle);
+        return at >= 0 ? at : pos;
+    }
+
+    return findUnicode(utf8, from, utf8.size(), m_needle);
+}
+
+qsizetype Matcher::indexIn(QStringView text, qsizetype from) const
+{
+    if (from < 0 || from > text.size())
+        return -1;
+    if (m_needle.isEmpty())
+        return from;
+
+    if (m_ascii) {
+        const qsizetype pos = findAscii(text.utf16(), text.size(), m_folded, from);
+        if (!m_foldsFromNonAscii)
+            return pos;
+        const qsizetype end = pos < 0 ? text.size() : std::min(text.size(), pos + m_folded.size());
+        const QStringView window = text.sliced(from, end - from);
+        if (!window.contains(QChar(kKelvinSign)) && !window.contains(QChar(kLongS)))
+            return pos;
+    }
+
+    return text.indexOf(m_needle, from, Qt::CaseInsensitive);
+}
+
+} // namespace TextSearch
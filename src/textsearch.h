@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QString>
+#include <QStringView>
+
+// Case-insensitive substring search shared by workspace search, the JSONL
+// filter and block filtering. A Matcher is built once per query and is safe
+// to use from several threads.
+//
+// ASCII needles are matched directly on UTF-8 bytes or UTF-16 units: a
+// vector pass (SSE2 where available) compares 16 bytes or 8 units at a time
+// against the needle's first and last character in both cases, and only
+// the positions where both line up are verified. Needles with non-ASCII
+// characters, and haystacks holding one of the two non-ASCII characters
+// that fold onto ASCII letters (KELVIN SIGN, LATIN SMALL LETTER LONG S),
+// take the Unicode path, so results always agree with
+// QString::indexOf(..., Qt::CaseInsensitive).
+namespace TextSearch {
+
+class Matcher
+{
+public:
+    Matcher() = default;
+    explicit Matcher(const QString &needle);
+
+    const QString &needle() const { return m_needle; }
+    bool isEmpty() const { return m_needle.isEmpty(); }
+    bool isAscii() const { return m_ascii; }
+
+    // Byte offset of the first match at or after `from` in UTF-8 text, or -1.
+    // `from` must be at a character boundary.
+    qsizetype indexIn(QByteArrayView utf8, qsizetype from = 0) const;
+    // UTF-16 offset of the first match at or after `from`, or -1
+    qsizetype indexIn(QStringView text, qsizetype from = 0) const;
+
+    bool matches(QByteArrayView utf8) const { return indexIn(utf8) >= 0; }
+    bool matches(QStringView text) const { return indexIn(text) >= 0; }
+
+private:
+    QString m_needle;
+    QByteArray m_folded;            // lowercase needle when ASCII
+    bool m_ascii = true;
+    bool m_foldsFromNonAscii = false;   // needle has a 'k' or an 's'
+};
+
+} // namespace TextSearch
@@ -18,6 +18,18 @@ QString generateHexId(int bits, const QString &prefix, const std::function<bool(
     return id;
 }
 
+quint64 contentHash(QStringView text)
+{
+    quint64 hash = 0xcbf29ce484222325ULL;
+    for (const QChar c : text) {
+        if (c == u'\r')
+            continue;
+        hash ^= c.unicode();
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
 QStringConverter::Encoding detectBomEncoding(QFile &file, bool &hasBom)
 {
     QByteArray bom = file.peek(4);
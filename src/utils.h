@@ -11,6 +11,10 @@ namespace Utils {
 // bits = number of random bits (24 → 6 hex chars).
 QString generateHexId(int bits, const QString &prefix, const std::function<bool(const QString &)> &exists);
 
+// 64-bit FNV-1a over UTF-16 code units, skipping '\r' so CRLF and LF text
+// hash alike. Used to compare block contents without comparing strings.
+quint64 contentHash(QStringView text);
+
 // Detect encoding from BOM. Returns Utf8 for files without a BOM.
 QStringConverter::Encoding detectBomEncoding(QFile &file, bool &hasBom);
 
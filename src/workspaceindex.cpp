@@ -0,0 +1,771 @@
+#include "workspaceindex.h"
+#include "mappedfile.h"
+
+#include <QBitArray>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QPointer>
+#include <QSaveFile>
+#include <QStringConverter>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+constexpr quint32 kManifestMagic = 0x42535749;      // "BSWI"
+constexpr quint32 kSegmentMagic = 0x42535753;       // "BSWS"
+constexpr quint32 kVersion = 1;
+constexpr auto kStreamVersion = QDataStream::Qt_6_0;
+constexpr qint64 kSegmentHeaderSize = 16;           // magic, version, doc count, key count
+constexpr quint32 kKeySpace = 1u << 21;             // three 7-bit ASCII bytes
+constexpr int kBatchFiles = 256;                    // files read in parallel per step
+constexpr qsizetype kSegmentPairs = 4 * 1024 * 1024;   // (trigram, document) pairs per new segment
+constexpr int kMaxSegments = 8;
+constexpr int kDebounceMs = 300;
+
+// Non-ASCII characters Qt folds onto 'k' and 's'. Files holding them can
+// match an ASCII query without containing its trigrams.
+constexpr QByteArrayView kKelvinSignUtf8("\xE2\x84\xAA");
+constexpr QByteArrayView kLongSUtf8("\xC5\xBF");
+enum FileFlag : quint8 { FoldsToAscii = 1 };
+
+QString manifestPath(const QString &dir)
+{
+    return dir + QStringLiteral("/index.dat");
+}
+
+QString segmentPath(const QString &dir, int id)
+{
+    return dir + QStringLiteral("/seg-%1.tri").arg(id);
+}
+
+// Sorted distinct keys of every trigram of ASCII bytes in `bytes`, folded
+// to lowercase. Trigrams touching a non-ASCII byte are not indexed.
+QVector<quint32> trigramsOf(QByteArrayView bytes)
+{
+    thread_local QBitArray seen(kKeySpace);
+    QVector<quint32> keys;
+    quint32 window = 0;
+    int ascii = 0;   // ASCII bytes at the end of the window, up to 3
+    for (char c : bytes) {
+        const uchar b = uchar(c);
+        if (b >= 0x80) {
+            ascii = 0;
+            continue;
+        }
+        const uchar folded = (b >= 'A' && b <= 'Z') ? uchar(b + ('a' - 'A')) : b;
+        window = ((window << 7) | folded) & (kKeySpace - 1);
+        ascii = std::min(ascii + 1, 3);
+        if (ascii == 3 && !seen.testBit(window)) {
+            seen.setBit(window);
+            keys.append(window);
+        }
+    }
+    for (quint32 key : std::as_const(keys))
+        seen.clearBit(key);
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+void appendVarint(QByteArray &out, quint32 value)
+{
+    while (value >= 0x80) {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+// Document numbers of one posting list (varint deltas, ascending)
+QVector<quint32> decodeDocs(QByteArrayView bytes)
+{
+    QVector<quint32> docs;
+    quint32 doc = 0;
+    quint32 value = 0;
+    int shift = 0;
+    for (char c : bytes) {
+        value |= quint32(uchar(c) & 0x7F) << shift;
+        if (uchar(c) & 0x80) {
+            shift += 7;
+            if (shift > 28)
+                return {};
+            continue;
+        }
+        doc += value;
+        docs.append(doc);
+        value = 0;
+        shift = 0;
+    }
+    return docs;
+}
+
+template <typename T>
+void appendLittleEndian(QByteArray &out, T value)
+{
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, sizeof(T));
+}
+
+// Streams one segment file: header, posting lists, then the key and
+// posting-start tables, which are only complete at the end
+class SegmentWriter
+{
+public:
+    explicit SegmentWriter(const QString &path)
+        : m_file(path)
+    {
+    }
+
+    bool open()
+    {
+        return m_file.open(QIODevice::WriteOnly)
+            && m_file.write(QByteArray(kSegmentHeaderSize, '\0')) == kSegmentHeaderSize;
+    }
+
+    // Keys in increasing order, `docs` ascending
+    void add(quint32 key, const QVector<quint32> &docs)
+    {
+        if (docs.isEmpty())
+            return;
+        QByteArray bytes;
+        quint32 previous = 0;
+        for (quint32 doc : docs) {
+            appendVarint(bytes, doc - previous);
+            previous = doc;
+        }
+        m_keys.append(key);
+        m_starts.append(m_size);
+        m_size += bytes.size();
+        m_file.write(bytes);
+    }
+
+    bool commit(quint32 docCount)
+    {
+        m_starts.append(m_size);
+        QByteArray tables;
+        tables.reserve(m_keys.size() * 4 + m_starts.size() * 8);
+        for (quint32 key : std::as_const(m_keys))
+            appendLittleEndian(tables, key);
+        for (quint64 start : std::as_const(m_starts))
+            appendLittleEndian(tables, start);
+
+        QByteArray header;
+        appendLittleEndian(header, kSegmentMagic);
+        appendLittleEndian(header, kVersion);
+        appendLittleEndian(header, docCount);
+        appendLittleEndian(header, quint32(m_keys.size()));
+
+        if (m_file.write(tables) != tables.size() || !m_file.seek(0)
+            || m_file.write(header) != header.size() || !m_file.commit()) {
+            qWarning("WorkspaceIndex: could not write %s", qPrintable(m_file.fileName()));
+            return false;
+        }
+        return true;
+    }
+
+private:
+    QSaveFile m_file;
+    QVector<quint32> m_keys;
+    QVector<quint64> m_starts;
+    quint64 m_size = 0;
+};
+
+// One file read for indexing
+struct Extracted {
+    QString path;
+    qint64 size = -1;          // -1: gone or unreadable
+    qint64 mtime = 0;
+    bool indexable = false;    // UTF-8 text the index can answer for
+    quint8 flags = 0;
+    QVector<quint32> keys;
+};
+
+Extracted extract(const QString &path)
+{
+    Extracted result;
+    result.path = path;
+    // Stat before reading, so a write in between shows up as a change next time
+    const QFileInfo info(path);
+    MappedFile file;
+    if (!info.isFile() || !file.open(path))
+        return result;
+    result.size = info.size();
+    result.mtime = info.lastModified().toMSecsSinceEpoch();
+
+    // UTF-16/32 files are decoded at search time; the index has no say
+    const QByteArrayView bytes(file.data(), file.size());
+    const auto bomEncoding = QStringConverter::encodingForData(bytes);
+    if (bomEncoding && *bomEncoding != QStringConverter::Utf8)
+        return result;
+
+    result.indexable = true;
+    if (bytes.contains(kKelvinSignUtf8) || bytes.contains(kLongSUtf8))
+        result.flags |= FoldsToAscii;
+    result.keys = trigramsOf(bytes);
+    return result;
+}
+
+bool writeSegment(const QString &path, QVector<quint64> &pairs, quint32 docCount)
+{
+    // Pairs are (key << 32 | doc); sorting groups them by key, docs ascending
+    std::sort(pairs.begin(), pairs.end());
+    SegmentWriter writer(path);
+    if (!writer.open())
+        return false;
+    QVector<quint32> docs;
+    for (qsizetype i = 0; i < pairs.size();) {
+        const quint32 key = quint32(pairs[i] >> 32);
+        docs.clear();
+        for (; i < pairs.size() && quint32(pairs[i] >> 32) == key; ++i)
+            docs.append(quint32(pairs[i]));
+        writer.add(key, docs);
+    }
+    return writer.commit(docCount);
+}
+
+} // namespace
+
+// --- Segment ---
+
+struct WorkspaceIndex::Segment
+{
+    int id = 0;
+    MappedFile file;
+    quint32 docCount = 0;
+    quint32 keyCount = 0;
+    const char *keys = nullptr;
+    const char *starts = nullptr;
+    quint64 postingsSize = 0;
+    std::atomic<bool> obsolete{false};    // delete the file with the last reference
+
+    ~Segment()
+    {
+        const QString path = file.filePath();
+        file.close();
+        if (obsolete.load())
+            QFile::remove(path);
+    }
+
+    bool open(const QString &path)
+    {
+        if (!file.open(path) || file.size() < kSegmentHeaderSize)
+            return false;
+        const char *data = file.data();
+        if (qFromLittleEndian<quint32>(data) != kSegmentMagic
+            || qFromLittleEndian<quint32>(data + 4) != kVersion)
+            return false;
+        docCount = qFromLittleEndian<quint32>(data + 8);
+        keyCount = qFromLittleEndian<quint32>(data + 12);
+
+        const qint64 tables = 4 * qint64(keyCount) + 8 * (qint64(keyCount) + 1);
+        if (file.size() < kSegmentHeaderSize + tables)
+            return false;
+        keys = data + file.size() - tables;
+        starts = keys + 4 * qint64(keyCount);
+        postingsSize = quint64(file.size() - kSegmentHeaderSize - tables);
+        return start(keyCount) == postingsSize;
+    }
+
+    quint32 keyAt(quint32 i) const { return qFromLittleEndian<quint32>(keys + 4 * qint64(i)); }
+    quint64 start(quint32 i) const { return qFromLittleEndian<quint64>(starts + 8 * qint64(i)); }
+
+    // Position of `key` in the key table, or -1
+    qint64 find(quint32 key) const
+    {
+        quint32 low = 0;
+        quint32 high = keyCount;
+        while (low < high) {
+            const quint32 mid = low + (high - low) / 2;
+            if (keyAt(mid) < key)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return low < keyCount && keyAt(low) == key ? qint64(low) : -1;
+    }
+
+    QByteArrayView postings(quint32 i) const
+    {
+        const quint64 begin = start(i);
+        const quint64 end = start(i + 1);
+        if (begin > end || end > postingsSize)
+            return {};
+        return QByteArrayView(file.data() + kSegmentHeaderSize + begin, qsizetype(end - begin));
+    }
+
+    // Documents holding every key, ascending
+    QVector<quint32> documentsWithAll(const QVector<quint32> &required) const
+    {
+        QVector<QByteArrayView> lists;
+        for (quint32 key : required) {
+            const qint64 i = find(key);
+            if (i < 0)
+                return {};
+            lists.append(postings(quint32(i)));
+        }
+        // Intersect starting from the shortest posting list
+        std::sort(lists.begin(), lists.end(),
+                  [](QByteArrayView a, QByteArrayView b) { return a.size() < b.size(); });
+        QVector<quint32> docs = decodeDocs(lists.first());
+        for (qsizetype l = 1; l < lists.size() && !docs.isEmpty(); ++l) {
+            const QVector<quint32> other = decodeDocs(lists[l]);
+            QVector<quint32> both;
+            std::set_intersection(docs.cbegin(), docs.cend(), other.cbegin(), other.cend(),
+                                  std::back_inserter(both));
+            docs = both;
+        }
+        return docs;
+    }
+};
+
+// --- Snapshot ---
+
+QStringList WorkspaceIndex::Snapshot::candidates(const QStringList &files,
+                                                 const QStringList &required,
+                                                 const QSet<QString> &unverified) const
+{
+    QVector<quint32> keys;
+    bool folds = false;
+    for (const QString &text : required) {
+        keys += trigramsOf(text.toUtf8());
+        folds = folds || text.contains(u'k', Qt::CaseInsensitive)
+                      || text.contains(u's', Qt::CaseInsensitive);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    if (keys.isEmpty())
+        return files;
+
+    QHash<int, QVector<quint32>> matches;
+    for (auto it = m_segments.cbegin(); it != m_segments.cend(); ++it)
+        matches.insert(it.key(), it.value()->documentsWithAll(keys));
+
+    QStringList result;
+    for (const QString &path : files) {
+        const auto it = m_files.constFind(path);
+        if (it == m_files.cend() || it->segment < 0 || (folds && (it->flags & FoldsToAscii))) {
+            result.append(path);
+            continue;
+        }
+        const auto docs = matches.constFind(it->segment);
+        if (docs != matches.cend() && std::binary_search(docs->cbegin(), docs->cend(), it->doc)) {
+            result.append(path);
+            continue;
+        }
+        // The postings only rule out the file as it was read. Watched files
+        // are re-read when they change; the rest are kept if their stat no
+        // longer matches.
+        if (!unverified.contains(path))
+            continue;
+        const QFileInfo info(path);
+        if (info.size() != it->size || info.lastModified().toMSecsSinceEpoch() != it->mtime)
+            result.append(path);
+    }
+    return result;
+}
+
+// --- WorkspaceIndex ---
+
+WorkspaceIndex::WorkspaceIndex(const QString &dir, QObject *parent)
+    : QObject(parent)
+    , m_dir(dir)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(kDebounceMs);
+    connect(&m_timer, &QTimer::timeout, this, &WorkspaceIndex::startJob);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &WorkspaceIndex::onFileChanged);
+}
+
+WorkspaceIndex::~WorkspaceIndex()
+{
+    if (m_cancel)
+        m_cancel->store(true);
+}
+
+void WorkspaceIndex::sync(const QStringList &files)
+{
+    m_files = files;
+    m_coverage = QSet<QString>(files.cbegin(), files.cend());
+
+    // Watch exactly the covered files. The job stats every file after the
+    // watches are in place, so no change falls between the two.
+    const QStringList watched = m_watcher.files();
+    const QSet<QString> watchedSet(watched.cbegin(), watched.cend());
+    QStringList unwatch;
+    for (const QString &path : watched) {
+        if (!m_coverage.contains(path))
+            unwatch.append(path);
+    }
+    QStringList watch;
+    for (const QString &path : files) {
+        if (!watchedSet.contains(path))
+            watch.append(path);
+    }
+    if (!unwatch.isEmpty())
+        m_watcher.removePaths(unwatch);
+    const QStringList failed = watch.isEmpty() ? QStringList() : m_watcher.addPaths(watch);
+    m_unwatched = QSet<QString>(failed.cbegin(), failed.cend());
+
+    m_fullSync = true;
+    m_timer.start();
+}
+
+void WorkspaceIndex::refresh(const QString &filePath)
+{
+    if (!m_coverage.contains(filePath))
+        return;
+    m_dirty.insert(filePath);
+    m_timer.start();
+}
+
+QSet<QString> WorkspaceIndex::unverifiedFiles() const
+{
+    return m_dirty + m_reading + m_unwatched;
+}
+
+void WorkspaceIndex::onFileChanged(const QString &path)
+{
+    // Saving by renaming over the file ends its watch; watch the new one
+    if (QFileInfo::exists(path) && !m_watcher.files().contains(path)) {
+        if (m_watcher.addPath(path))
+            m_unwatched.remove(path);
+        else
+            m_unwatched.insert(path);
+    }
+    refresh(path);
+}
+
+void WorkspaceIndex::startJob()
+{
+    if (m_running) {
+        m_rerun = true;
+        return;
+    }
+    if (!m_fullSync && m_dirty.isEmpty())
+        return;
+
+    Job job;
+    job.dir = m_dir;
+    job.base = m_snapshot;
+    job.files = m_files;
+    job.full = std::exchange(m_fullSync, false) || !m_snapshot;
+    job.dirty = std::exchange(m_dirty, {});
+    m_reading = job.dirty;
+
+    m_running = true;
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    m_cancel = cancel;
+    QPointer<WorkspaceIndex> self(this);
+    (void)QtConcurrent::run([self, job, cancel]() {
+        std::shared_ptr<const Snapshot> result = runJob(job, *cancel);
+        if (cancel->load())
+            return;
+        QMetaObject::invokeMethod(self, [self, result]() {
+            if (self)
+                self->finishJob(result);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void WorkspaceIndex::finishJob(std::shared_ptr<const Snapshot> result)
+{
+    m_running = false;
+    m_reading.clear();
+    if (result) {
+        m_snapshot = std::move(result);
+    } else {
+        // Whatever the index missed is unknown now; search everything until
+        // the next full sync succeeds
+        m_snapshot.reset();
+        m_fullSync = true;
+    }
+    if (std::exchange(m_rerun, false))
+        m_timer.start();
+}
+
+std::shared_ptr<const WorkspaceIndex::Snapshot> WorkspaceIndex::runJob(
+    const Job &job, const std::atomic<bool> &cancel)
+{
+    QDir().mkpath(job.dir);
+    auto next = std::make_shared<Snapshot>(job.base ? *job.base : load(job.dir));
+    QVector<std::shared_ptr<Segment>> created;
+    QVector<std::shared_ptr<Segment>> retired;
+    auto fail = [&created]() {
+        for (const auto &segment : std::as_const(created))
+            segment->obsolete.store(true);
+        return std::shared_ptr<const Snapshot>();
+    };
+
+    // Keep files whose stat still matches; everything else is read again
+    QStringList toRead;
+    if (job.full) {
+        QHash<QString, Snapshot::File> kept;
+        kept.reserve(job.files.size());
+        for (const QString &path : job.files) {
+            if (cancel.load())
+                return fail();
+            const auto it = next->m_files.constFind(path);
+            if (it != next->m_files.cend() && !job.dirty.contains(path)) {
+                const QFileInfo info(path);
+                if (info.size() == it->size && info.lastModified().toMSecsSinceEpoch() == it->mtime) {
+                    kept.insert(path, *it);
+                    continue;
+                }
+            }
+            toRead.append(path);
+        }
+        next->m_files = kept;
+    } else {
+        for (const QString &path : job.dirty) {
+            next->m_files.remove(path);
+            toRead.append(path);
+        }
+    }
+
+    // Read in parallel batches; every kSegmentPairs postings become a segment
+    QVector<quint64> pairs;
+    quint32 docCount = 0;
+    QVector<std::pair<QString, Snapshot::File>> pending;
+    auto flush = [&]() {
+        if (docCount == 0)
+            return true;
+        const int id = next->m_nextSegmentId++;
+        auto segment = std::make_shared<Segment>();
+        segment->id = id;
+        if (!writeSegment(segmentPath(job.dir, id), pairs, docCount)
+            || !segment->open(segmentPath(job.dir, id)))
+            return false;
+        created.append(segment);
+        next->m_segments.insert(id, segment);
+        for (auto &[path, file] : pending) {
+            file.segment = id;
+            next->m_files.insert(path, file);
+        }
+        pairs.clear();
+        pending.clear();
+        docCount = 0;
+        return true;
+    };
+
+    for (qsizetype start = 0; start < toRead.size(); start += kBatchFiles) {
+        if (cancel.load())
+            return fail();
+        const QVector<Extracted> batch = QtConcurrent::blockingMapped<QVector<Extracted>>(
+            toRead.mid(start, kBatchFiles), extract);
+        for (const Extracted &e : batch) {
+            if (e.size < 0)
+                continue;
+            Snapshot::File file;
+            file.size = e.size;
+            file.mtime = e.mtime;
+            file.flags = e.flags;
+            if (!e.indexable) {
+                next->m_files.insert(e.path, file);
+                continue;
+            }
+            file.doc = docCount++;
+            for (quint32 key : e.keys)
+                pairs.append(quint64(key) << 32 | file.doc);
+            pending.append({ e.path, file });
+        }
+        if (pairs.size() >= kSegmentPairs && !flush())
+            return fail();
+    }
+    if (!flush() || !compact(job.dir, *next, retired, created) || !save(job.dir, *next))
+        return fail();
+
+    // The manifest no longer references these; drop them with their last reader
+    for (const auto &segment : std::as_const(retired))
+        segment->obsolete.store(true);
+    return next;
+}
+
+bool WorkspaceIndex::compact(const QString &dir, Snapshot &snapshot,
+                             QVector<std::shared_ptr<Segment>> &retired,
+                             QVector<std::shared_ptr<Segment>> &created)
+{
+    // Path of every live document, per segment (empty for dead documents)
+    QHash<int, QStringList> docPaths;
+    QHash<int, int> live;
+    for (auto it = snapshot.m_files.cbegin(); it != snapshot.m_files.cend(); ++it) {
+        if (it->segment < 0)
+            continue;
+        QStringList &paths = docPaths[it->segment];
+        if (paths.isEmpty())
+            paths.resize(snapshot.m_segments.value(it->segment)->docCount);
+        paths[it->doc] = it.key();
+        ++live[it->segment];
+    }
+
+    // Drop dead segments, rewrite mostly dead ones, and merge the smallest
+    // until few enough remain
+    QVector<int> merge;
+    QVector<int> rest;
+    for (auto it = snapshot.m_segments.cbegin(); it != snapshot.m_segments.cend(); ++it) {
+        const int count = live.value(it.key());
+        if (count == 0)
+            retired.append(it.value());
+        else if (count * 2 < int(it.value()->docCount))
+            merge.append(it.key());
+        else
+            rest.append(it.key());
+    }
+    for (const auto &segment : std::as_const(retired))
+        snapshot.m_segments.remove(segment->id);
+
+    std::sort(rest.begin(), rest.end(),
+              [&live](int a, int b) { return live.value(a) < live.value(b); });
+    while (!rest.isEmpty() && rest.size() + (merge.isEmpty() ? 0 : 1) > kMaxSegments)
+        merge.append(rest.takeFirst());
+    if (merge.isEmpty())
+        return true;
+    std::sort(merge.begin(), merge.end());
+
+    // New document numbers follow segment order, then old order, so the
+    // merged posting lists come out sorted
+    QHash<int, QVector<qint64>> remap;
+    quint32 docCount = 0;
+    QVector<std::shared_ptr<Segment>> sources;
+    for (int id : std::as_const(merge)) {
+        const QStringList &paths = docPaths[id];
+        QVector<qint64> &map = remap[id];
+        map.fill(-1, paths.size());
+        for (qsizetype i = 0; i < paths.size(); ++i) {
+            if (!paths[i].isEmpty())
+                map[i] = docCount++;
+        }
+        sources.append(snapshot.m_segments.value(id));
+    }
+
+    const int id = snapshot.m_nextSegmentId++;
+    SegmentWriter writer(segmentPath(dir, id));
+    if (!writer.open())
+        return false;
+    QVector<quint32> cursors(sources.size(), 0);
+    QVector<quint32> docs;
+    for (;;) {
+        // Smallest key under any cursor
+        bool any = false;
+        quint32 key = 0;
+        for (qsizetype s = 0; s < sources.size(); ++s) {
+            if (cursors[s] < sources[s]->keyCount) {
+                const quint32 k = sources[s]->keyAt(cursors[s]);
+                key = any ? std::min(key, k) : k;
+                any = true;
+            }
+        }
+        if (!any)
+            break;
+
+        docs.clear();
+        for (qsizetype s = 0; s < sources.size(); ++s) {
+            if (cursors[s] >= sources[s]->keyCount || sources[s]->keyAt(cursors[s]) != key)
+                continue;
+            const QVector<qint64> &map = remap[sources[s]->id];
+            for (quint32 doc : decodeDocs(sources[s]->postings(cursors[s]))) {
+                if (doc < quint32(map.size()) && map[doc] >= 0)
+                    docs.append(quint32(map[doc]));
+            }
+            ++cursors[s];
+        }
+        writer.add(key, docs);
+    }
+
+    auto merged = std::make_shared<Segment>();
+    merged->id = id;
+    if (!writer.commit(docCount) || !merged->open(segmentPath(dir, id)))
+        return false;
+    created.append(merged);
+
+    for (const auto &source : std::as_const(sources)) {
+        const QStringList &paths = docPaths[source->id];
+        const QVector<qint64> &map = remap[source->id];
+        for (qsizetype i = 0; i < paths.size(); ++i) {
+            if (map[i] < 0)
+                continue;
+            Snapshot::File &file = snapshot.m_files[paths[i]];
+            file.segment = id;
+            file.doc = quint32(map[i]);
+        }
+        snapshot.m_segments.remove(source->id);
+        retired.append(source);
+    }
+    snapshot.m_segments.insert(id, merged);
+    return true;
+}
+
+WorkspaceIndex::Snapshot WorkspaceIndex::load(const QString &dir)
+{
+    Snapshot snapshot;
+    QFile file(manifestPath(dir));
+    if (file.open(QIODevice::ReadOnly)) {
+        QDataStream in(&file);
+        in.setVersion(kStreamVersion);
+        quint32 magic = 0, version = 0;
+        in >> magic >> version;
+        if (magic == kManifestMagic && version == kVersion) {
+            qint32 nextId = 1;
+            QVector<qint32> ids;
+            qint32 count = 0;
+            in >> nextId >> ids >> count;
+            for (qint32 id : std::as_const(ids)) {
+                auto segment = std::make_shared<Segment>();
+                segment->id = id;
+                if (id < nextId && segment->open(segmentPath(dir, id)))
+                    snapshot.m_segments.insert(id, segment);
+            }
+            // Files in a missing or damaged segment are read again on sync
+            for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                QString path;
+                Snapshot::File entry;
+                in >> path >> entry.segment >> entry.doc >> entry.size >> entry.mtime >> entry.flags;
+                const auto segment = snapshot.m_segments.constFind(entry.segment);
+                if (entry.segment < 0
+                    || (segment != snapshot.m_segments.cend() && entry.doc < (*segment)->docCount))
+                    snapshot.m_files.insert(path, entry);
+            }
+            if (in.status() == QDataStream::Ok)
+                snapshot.m_nextSegmentId = nextId;
+            else
+                snapshot = Snapshot();
+        }
+    }
+
+    // Segments the manifest does not reference are left over from
+    // interrupted jobs or replaced segments that could not be deleted
+    const QStringList names =
+        QDir(dir).entryList({ QStringLiteral("seg-*.tri") }, QDir::Files);
+    for (const QString &name : names) {
+        const int id = name.mid(4, name.size() - 8).toInt();
+        if (!snapshot.m_segments.contains(id))
+            QFile::remove(dir + QLatin1Char('/') + name);
+    }
+    return snapshot;
+}
+
+bool WorkspaceIndex::save(const QString &dir, const Snapshot &snapshot)
+{
+    QSaveFile file(manifestPath(dir));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning("WorkspaceIndex: could not write %s", qPrintable(file.fileName()));
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(kStreamVersion);
+    QVector<qint32> ids;
+    for (auto it = snapshot.m_segments.cbegin(); it != snapshot.m_segments.cend(); ++it)
+        ids.append(it.key());
+    out << kManifestMagic << kVersion << qint32(snapshot.m_nextSegmentId) << ids
+        << qint32(snapshot.m_files.size());
+    for (auto it = snapshot.m_files.cbegin(); it != snapshot.m_files.cend(); ++it)
+        out << it.key() << it->segment << it->doc << it->size << it->mtime << it->flags;
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        qWarning("WorkspaceIndex: could not write %s", qPrintable(file.fileName()));
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+// Persistent trigram index over the text files global search covers, kept
+// in `dir` so a restart only re-reads what changed. Search asks it which
+// files can contain a query and reads only those.
+//
+// Each indexed file is a document in one immutable segment file: sorted
+// ASCII-folded trigram keys with varint-delta posting lists, memory-mapped
+// and binary-searched in place. A small manifest maps paths to
+// (segment, document) plus the size and mtime they were read at. Updates
+// write new segments for changed files; their old documents simply stop
+// being referenced, and segments that are mostly dead or too numerous are
+// merged on the thread pool. Segment files are deleted once no snapshot
+// uses them.
+//
+// Covered files are watched, so changes made by other programs are re-read
+// without search having to stat every file it rules out.
+class WorkspaceIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    class Snapshot;
+
+    explicit WorkspaceIndex(const QString &dir, QObject *parent = nullptr);
+    ~WorkspaceIndex() override;
+
+    // Cover exactly `files`: new files and files whose size or mtime changed
+    // are read, the rest are dropped. Runs on the thread pool.
+    void sync(const QStringList &files);
+    // Re-read a covered file now, e.g. after a save
+    void refresh(const QString &filePath);
+
+    // Null until the first sync has finished
+    std::shared_ptr<const Snapshot> snapshot() const { return m_snapshot; }
+    // Files the snapshot may be behind on: changed and not yet re-read, or
+    // not watched (the system's watch limit was reached)
+    QSet<QString> unverifiedFiles() const;
+
+private:
+    struct Segment;
+    struct Job {
+        QString dir;
+        std::shared_ptr<const Snapshot> base;   // null: start from the manifest on disk
+        QStringList files;                      // coverage, for full syncs
+        bool full = false;
+        QSet<QString> dirty;                    // read regardless of size and mtime
+    };
+
+    void onFileChanged(const QString &path);
+    void startJob();
+    void finishJob(std::shared_ptr<const Snapshot> result);
+    static std::shared_ptr<const Snapshot> runJob(const Job &job, const std::atomic<bool> &cancel);
+    static Snapshot load(const QString &dir);
+    static bool save(const QString &dir, const Snapshot &snapshot);
+    static bool compact(const QString &dir, Snapshot &snapshot,
+                        QVector<std::shared_ptr<Segment>> &retired,
+                        QVector<std::shared_ptr<Segment>> &created);
+
+    QString m_dir;
+    std::shared_ptr<const Snapshot> m_snapshot;
+    QStringList m_files;
+    QSet<QString> m_coverage;
+    QSet<QString> m_dirty;
+    QSet<QString> m_reading;       // dirty files the running job re-reads
+    QSet<QString> m_unwatched;
+    QFileSystemWatcher m_watcher;
+    bool m_fullSync = false;
+    bool m_running = false;
+    bool m_rerun = false;          // work arrived while a job ran
+    QTimer m_timer;                // batches saves and scans
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+};
+
+// Immutable view of the index. Jobs build a new snapshot and swap it in;
+// searches keep whichever one they loaded.
+class WorkspaceIndex::Snapshot
+{
+public:
+    // Of `files`, those that may contain every string in `required`,
+    // compared case-insensitively. Files the index cannot answer for (not
+    // yet indexed or not UTF-8) are always kept. Files in `unverified` that
+    // the postings rule out are kept if they changed on disk since they
+    // were read; the others are trusted without a stat.
+    QStringList candidates(const QStringList &files, const QStringList &required,
+                           const QSet<QString> &unverified) const;
+
+private:
+    friend class WorkspaceIndex;
+
+    struct File {
+        qint32 segment = -1;      // -1: not indexable, always a candidate
+        quint32 doc = 0;
+        qint64 size = 0;
+        qint64 mtime = 0;         // msecs since epoch
+        quint8 flags = 0;
+    };
+
+    QHash<QString, File> m_files;
+    QMap<int, std::shared_ptr<Segment>> m_segments;   // by id
+    int m_nextSegmentId = 1;
+};